@@ -542,9 +542,59 @@ out:
 	return ret;
 }
 
+static int stats_info(int ddbnum)
+{
+	struct ddb_fe_stats st[64];
+	struct ddb_stats req = { .num = 64, .stats = st };
+	char ddbname[80];
+	int ddb, ret;
+	uint32_t i;
+
+	sprintf(ddbname, "/dev/ddbridge/card%d", ddbnum);
+	ddb = open(ddbname, O_RDWR);
+	if (ddb < 0)
+		return -3;
+	ret = ioctl(ddb, IOCTL_DDB_GET_STATS, &req);
+	close(ddb);
+	if (ret < 0) {
+		printf("%s: no statistics: %s\n", ddbname, strerror(errno));
+		return 0;
+	}
+	printf("\n\nCard %s: %u inputs\n", ddbname, req.total);
+	printf("lnk port inp status strength(dBm)      cnr(dB)       ber       ucb  stall  loss\n");
+	for (i = 0; i < req.total && i < req.num; i++) {
+		printf("%3u %4u %3u ", st[i].link, st[i].port, st[i].input);
+		if (!(st[i].flags & DDB_FE_STATS_FE)) {
+			printf("    --\n");
+			continue;
+		}
+		if (st[i].flags & DDB_FE_STATS_STATUS)
+			printf("  %s ", (st[i].status & 0x10 /* FE_HAS_LOCK */) ? "LOCK" : " ---");
+		else
+			printf("    ?? ");
+		if (st[i].strength_scale == 1)
+			printf("%13.3f ", st[i].strength / 1000.0);
+		else
+			printf("%13s ", "-");
+		if (st[i].cnr_scale == 1)
+			printf("%12.3f ", st[i].cnr / 1000.0);
+		else
+			printf("%12s ", "-");
+		if (st[i].post_bit_count)
+			printf("%9.2e ", (double) st[i].post_bit_error /
+			       st[i].post_bit_count);
+		else
+			printf("%9s ", "-");
+		printf("%9llu %6u %5u\n",
+		       (unsigned long long) st[i].block_error,
+		       st[i].dma_stall, st[i].dma_packet_loss);
+	}
+	return 0;
+}
+
 int main(int argc, char*argv[])
 {
-	int fd = -1, all = 1, i, ret = 0;
+	int fd = -1, all = 1, stats = 0, i, ret = 0;
 	char fn[128];
 	int32_t device = -1, demod = -1;
 	
@@ -555,9 +605,10 @@ int main(int argc, char*argv[])
 		static struct option long_options[] = {
 			{"device", required_argument, 0, 'd'},
 			{"demod", required_argument, 0, 'n'},
+			{"stats", no_argument, 0, 's'},
 			{0, 0, 0, 0}
 		};
-                c = getopt_long(argc, argv, "ad:n:",
+                c = getopt_long(argc, argv, "ad:n:s",
 				long_options, &option_index);
 		if (c == -1)
 			break;
@@ -571,6 +622,9 @@ int main(int argc, char*argv[])
 		case 'a':
 			all = 1;
 			break;
+		case 's':
+			stats = 1;
+			break;
 		default:
 			break;
 		}
@@ -580,10 +634,10 @@ int main(int argc, char*argv[])
 		exit(1);
 	}
 	if (device >=0)
-		ret = card_info(device, demod);
+		ret = stats ? stats_info(device) : card_info(device, demod);
 	else
 		for (i = 0; i < 100; i++) {
-			ret = card_info(i, -1);
+			ret = stats ? stats_info(i) : card_info(i, -1);
 			
 			if (ret == -3)     /* could not open, no more cards! */
 				break; 
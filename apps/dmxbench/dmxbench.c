@@ -0,0 +1,280 @@
+/*
+ * dmxbench - measure the throughput of the software demux
+ *
+ * Builds dvb-core/dvb_demux.c and dvb_ringbuffer.c against a small
+ * userspace shim and feeds them generated transport streams.
+ *
+ * Paths measured:
+ *   packets  dvb_dmx_swfilter_packets() with aligned TS feeds
+ *   swfilter _dvb_dmx_swfilter() via dvb_dmx_swfilter(), unaligned start
+ *   section  dvb_dmx_swfilter_packets() with section feeds only
+ *
+ * TS feed data is written to a dvb_ringbuffer like dmxdev does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+#include <media/dvb_demux.h>
+#include <media/dvb_ringbuffer.h>
+
+#define BUF_PACKETS  (16 * 1024)
+#define RBUF_SIZE    (2 * 1024 * 1024)
+
+static int ts_pids = 16;
+static int sec_pids = 4;
+static int errors;          /* errors per 1000 packets */
+static int unaligned = 7;   /* garbage bytes before the first packet */
+static long loops = 100;
+
+static struct dvb_ringbuffer rbuf;
+static uint8_t rbuf_mem[RBUF_SIZE];
+static uint64_t ts_bytes, sec_count;
+
+u32 crc32_be(u32 crc, const u8 *p, size_t len)
+{
+	static u32 tab[256];
+	u32 i, j, c;
+
+	if (!tab[1])
+		for (i = 0; i < 256; i++) {
+			for (c = i << 24, j = 0; j < 8; j++)
+				c = (c << 1) ^ ((c & 0x80000000) ? 0x04c11db7 : 0);
+			tab[i] = c;
+		}
+	while (len--)
+		crc = (crc << 8) ^ tab[((crc >> 24) ^ *p++) & 0xff];
+	return crc;
+}
+
+static int ts_cb(const u8 *buf1, size_t len1, const u8 *buf2, size_t len2,
+		 struct dmx_ts_feed *source, u32 *buffer_flags)
+{
+	if (dvb_ringbuffer_free(&rbuf) < len1 + len2)
+		dvb_ringbuffer_flush(&rbuf);
+	dvb_ringbuffer_write(&rbuf, buf1, len1);
+	if (len2)
+		dvb_ringbuffer_write(&rbuf, buf2, len2);
+	ts_bytes += len1 + len2;
+	return 0;
+}
+
+static int sec_cb(const u8 *buf1, size_t len1, const u8 *buf2, size_t len2,
+		  struct dmx_section_filter *source, u32 *buffer_flags)
+{
+	sec_count++;
+	return 0;
+}
+
+static int start_feed(struct dvb_demux_feed *feed)
+{
+	return 0;
+}
+
+static int stop_feed(struct dvb_demux_feed *feed)
+{
+	return 0;
+}
+
+/* a private section of seclen bytes split over TS packets of pid */
+static int put_section(uint8_t *ts, uint16_t pid, uint8_t *cc, int seclen,
+		       uint8_t version)
+{
+	uint8_t sec[4096];
+	int i, n = 0, off = 0, len;
+	u32 crc;
+
+	sec[0] = 0x42;
+	sec[1] = 0xb0 | (((seclen - 3) >> 8) & 0x0f);
+	sec[2] = (seclen - 3) & 0xff;
+	sec[3] = pid >> 8;
+	sec[4] = pid & 0xff;
+	sec[5] = 0xc1 | ((version & 0x1f) << 1);
+	sec[6] = sec[7] = 0;
+	for (i = 8; i < seclen - 4; i++)
+		sec[i] = i;
+	crc = crc32_be(0xffffffff, sec, seclen - 4);
+	sec[seclen - 4] = crc >> 24;
+	sec[seclen - 3] = crc >> 16;
+	sec[seclen - 2] = crc >> 8;
+	sec[seclen - 1] = crc;
+
+	while (off < seclen) {
+		uint8_t *p = ts + n * 188;
+		int hdr = 4;
+
+		p[0] = 0x47;
+		p[1] = (off ? 0x00 : 0x40) | (pid >> 8);
+		p[2] = pid & 0xff;
+		p[3] = 0x10 | ((*cc)++ & 0x0f);
+		if (!off)
+			p[hdr++] = 0;
+		len = min(188 - hdr, seclen - off);
+		memcpy(p + hdr, sec + off, len);
+		memset(p + hdr + len, 0xff, 188 - hdr - len);
+		off += len;
+		n++;
+	}
+	return n;
+}
+
+static int gen_stream(uint8_t *ts, int npkt)
+{
+	uint8_t cc[8192] = { 0 };
+	int i = 0, n, pid;
+	uint32_t r = 12345;
+
+	while (i < npkt) {
+		r = r * 1103515245 + 12345;
+		if (sec_pids && (r >> 8) % 8 == 0 && i + 2 <= npkt) {
+			pid = 0x1000 + (r >> 16) % sec_pids;
+			i += put_section(ts + i * 188, pid, &cc[pid], 300,
+					 (r >> 20) & 0x1f);
+			continue;
+		}
+		if (!ts_pids) {
+			pid = 0x1fff;
+		} else {
+			pid = 0x100 + (r >> 16) % ts_pids;
+		}
+		n = i * 188;
+		ts[n] = 0x47;
+		ts[n + 1] = pid >> 8;
+		ts[n + 2] = pid & 0xff;
+		ts[n + 3] = 0x10 | (cc[pid]++ & 0x0f);
+		memset(ts + n + 4, r & 0xff, 184);
+		if (errors && (r >> 4) % 1000 < errors) {
+			if (r & 1)
+				ts[n + 1] |= 0x80;	/* TEI */
+			else
+				cc[pid]++;		/* CC error */
+		}
+		i++;
+	}
+	return i;
+}
+
+static double now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, long pkts, double dt)
+{
+	printf("%-9s %12.0f pkt/s %8.2f ns/pkt %9.1f MBit/s\n", name,
+	       pkts / dt, dt * 1e9 / pkts, pkts * 188.0 * 8 / dt / 1e6);
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"usage: dmxbench [-p ts_pids] [-s section_pids] [-e errors_per_mille]\n"
+		"                [-u unaligned_bytes] [-l loops]\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	struct dvb_demux demux;
+	struct dmx_ts_feed *tsfeed;
+	struct dmx_section_feed *secfeed;
+	struct dmx_section_filter *secfilter;
+	uint8_t *ts;
+	double t;
+	long l;
+	int c, i, npkt;
+
+	while ((c = getopt(argc, argv, "p:s:e:u:l:h")) != -1) {
+		switch (c) {
+		case 'p':
+			ts_pids = strtol(optarg, NULL, 0);
+			break;
+		case 's':
+			sec_pids = strtol(optarg, NULL, 0);
+			break;
+		case 'e':
+			errors = strtol(optarg, NULL, 0);
+			break;
+		case 'u':
+			unaligned = strtol(optarg, NULL, 0) % 188;
+			break;
+		case 'l':
+			loops = strtol(optarg, NULL, 0);
+			break;
+		default:
+			usage();
+		}
+	}
+	if (ts_pids + sec_pids > 200)
+		usage();
+
+	ts = malloc(BUF_PACKETS * 188 + 188);
+	if (!ts)
+		return 1;
+	memset(ts, 0x55, unaligned);
+	npkt = gen_stream(ts + unaligned, BUF_PACKETS);
+	dvb_ringbuffer_init(&rbuf, rbuf_mem, RBUF_SIZE);
+
+	memset(&demux, 0, sizeof(demux));
+	demux.filternum = 256;
+	demux.feednum = 256;
+	demux.start_feed = start_feed;
+	demux.stop_feed = stop_feed;
+	if (dvb_dmx_init(&demux) < 0)
+		return 1;
+
+	for (i = 0; i < ts_pids; i++) {
+		if (demux.dmx.allocate_ts_feed(&demux.dmx, &tsfeed, ts_cb) < 0)
+			return 1;
+		tsfeed->set(tsfeed, 0x100 + i, TS_PACKET, DMX_PES_OTHER, 0);
+		tsfeed->start_filtering(tsfeed);
+	}
+	for (i = 0; i < sec_pids; i++) {
+		if (demux.dmx.allocate_section_feed(&demux.dmx, &secfeed, sec_cb) < 0)
+			return 1;
+		secfeed->set(secfeed, 0x1000 + i, 1);
+		secfeed->allocate_filter(secfeed, &secfilter);
+		memset(secfilter->filter_mask, 0, DMX_MAX_FILTER_SIZE);
+		memset(secfilter->filter_mode, 0xff, DMX_MAX_FILTER_SIZE);
+		secfilter->filter_value[0] = 0x42;
+		secfilter->filter_mask[0] = 0xff;
+		secfeed->start_filtering(secfeed);
+	}
+
+	printf("%d packets, %d ts pids, %d section pids, %d errors/1000, %ld loops\n",
+	       npkt, ts_pids, sec_pids, errors, loops);
+
+	t = now();
+	for (l = 0; l < loops; l++)
+		dvb_dmx_swfilter_packets(&demux, ts + unaligned, npkt);
+	report("packets", npkt * loops, now() - t);
+
+	t = now();
+	for (l = 0; l < loops; l++)
+		dvb_dmx_swfilter(&demux, ts, npkt * 188 + unaligned);
+	report("swfilter", npkt * loops, now() - t);
+
+	printf("ts bytes %llu, sections %llu\n",
+	       (unsigned long long)ts_bytes, (unsigned long long)sec_count);
+
+	/* section path only */
+	ts_pids = 0;
+	sec_pids = sec_pids ? sec_pids : 1;
+	npkt = gen_stream(ts + unaligned, BUF_PACKETS);
+	sec_count = 0;
+	t = now();
+	for (l = 0; l < loops; l++)
+		dvb_dmx_swfilter_packets(&demux, ts + unaligned, npkt);
+	report("section", npkt * loops, now() - t);
+	printf("sections %llu\n", (unsigned long long)sec_count);
+
+	dvb_dmx_release(&demux);
+	free(ts);
+	return 0;
+}
@@ -0,0 +1,178 @@
+/*
+ * Minimal userspace replacements for the kernel interfaces used by
+ * dvb_demux.c and dvb_ringbuffer.c, so that they can be benchmarked
+ * without a card. Locks are no-ops, the benchmark is single threaded.
+ */
+
+#ifndef _DMXBENCH_KSHIM_H_
+#define _DMXBENCH_KSHIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#define ERESTARTSYS 512
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+typedef uint8_t __u8;
+typedef uint16_t __u16;
+typedef uint32_t __u32;
+typedef uint64_t __u64;
+typedef int8_t __s8;
+typedef int16_t __s16;
+typedef int32_t __s32;
+typedef int64_t __s64;
+typedef _Bool bool;
+#define true 1
+#define false 0
+
+#define __user
+#define __iomem
+#define __force
+#define likely(x) __builtin_expect(!!(x), 1)
+#define unlikely(x) __builtin_expect(!!(x), 0)
+
+#define LINUX_VERSION_CODE KERNEL_VERSION(6, 0, 0)
+#define KERNEL_VERSION(a, b, c) (((a) << 16) + ((b) << 8) + (c))
+
+#define EXPORT_SYMBOL(x)
+#define EXPORT_SYMBOL_GPL(x)
+#define MODULE_PARM_DESC(a, b)
+#define module_param(a, b, c)
+
+#define KERN_ERR ""
+#define KERN_WARNING ""
+#define KERN_INFO ""
+#define KERN_DEBUG ""
+#define printk(...) do { } while (0)
+#define printk_ratelimit() 0
+#define pr_err(...) do { } while (0)
+#define pr_warn(...) do { } while (0)
+#define pr_info(...) do { } while (0)
+#define pr_debug(...) do { } while (0)
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define array_size(a, b) ((a) * (b))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define container_of(ptr, type, member) \
+	((type *)((char *)(ptr) - offsetof(type, member)))
+
+#define READ_ONCE(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define WRITE_ONCE(x, v) __atomic_store_n(&(x), (v), __ATOMIC_RELAXED)
+#define smp_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define smp_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+#define GFP_KERNEL 0
+#define vmalloc(s) malloc(s)
+#define vfree(p) free(p)
+#define kmalloc(s, f) malloc(s)
+#define kzalloc(s, f) calloc(1, s)
+#define kfree(p) free(p)
+#define IS_ERR(p) ((unsigned long)(p) >= (unsigned long)-4095)
+#define PTR_ERR(p) ((long)(p))
+#define ERR_PTR(e) ((void *)(long)(e))
+
+static inline void *memdup_user(const void *src, size_t len)
+{
+	void *p = malloc(len);
+
+	if (!p)
+		return ERR_PTR(-ENOMEM);
+	memcpy(p, src, len);
+	return p;
+}
+
+#define copy_from_user(d, s, n) (memcpy((d), (s), (n)), 0)
+#define copy_to_user(d, s, n) (memcpy((d), (s), (n)), 0)
+
+typedef struct { int dummy; } spinlock_t;
+#define spin_lock_init(l) do { } while (0)
+#define spin_lock(l) do { } while (0)
+#define spin_unlock(l) do { } while (0)
+#define spin_lock_irq(l) do { } while (0)
+#define spin_unlock_irq(l) do { } while (0)
+#define spin_lock_irqsave(l, f) do { (void)(f); } while (0)
+#define spin_unlock_irqrestore(l, f) do { (void)(f); } while (0)
+
+struct mutex { int dummy; };
+#define mutex_init(m) do { } while (0)
+#define mutex_lock(m) do { } while (0)
+#define mutex_unlock(m) do { } while (0)
+#define mutex_lock_interruptible(m) 0
+
+typedef struct { int dummy; } wait_queue_head_t;
+#define init_waitqueue_head(q) do { } while (0)
+#define wake_up(q) do { } while (0)
+#define wake_up_interruptible(q) do { } while (0)
+
+struct task_struct;
+#define current ((struct task_struct *)0)
+#define signal_pending(t) 0
+
+struct timer_list { int dummy; };
+
+typedef s64 ktime_t;
+
+static inline ktime_t ktime_get(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (s64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#define ktime_to_ns(t) (t)
+#define ktime_to_ms(t) ((t) / 1000000)
+#define ktime_sub(a, b) ((a) - (b))
+#define ktime_ms_delta(a, b) (((a) - (b)) / 1000000)
+#define div64_u64(a, b) ((a) / (b))
+
+struct list_head {
+	struct list_head *next, *prev;
+};
+
+#define LIST_HEAD_INIT(name) { &(name), &(name) }
+#define INIT_LIST_HEAD(l) do { (l)->next = (l); (l)->prev = (l); } while (0)
+
+static inline void list_add(struct list_head *n, struct list_head *head)
+{
+	n->next = head->next;
+	n->prev = head;
+	head->next->prev = n;
+	head->next = n;
+}
+
+static inline void list_del(struct list_head *e)
+{
+	e->prev->next = e->next;
+	e->next->prev = e->prev;
+}
+
+static inline int list_empty(const struct list_head *head)
+{
+	return head->next == head;
+}
+
+#define list_entry(ptr, type, member) container_of(ptr, type, member)
+#define list_for_each_entry(pos, head, member)				\
+	for (pos = list_entry((head)->next, __typeof__(*pos), member);	\
+	     &pos->member != (head);					\
+	     pos = list_entry(pos->member.next, __typeof__(*pos), member))
+#define list_for_each_safe(pos, n, head)				\
+	for (pos = (head)->next, n = pos->next; pos != (head);		\
+	     pos = n, n = pos->next)
+
+u32 crc32_be(u32 crc, const u8 *p, size_t len);
+
+#endif
@@ -40,6 +40,11 @@ static int ci_bitrate = 70000;
 module_param(ci_bitrate, int, 0444);
 MODULE_PARM_DESC(ci_bitrate, " Bitrate in KHz for output to CI.");
 
+static int ci_bitrate_auto;
+module_param(ci_bitrate_auto, int, 0444);
+MODULE_PARM_DESC(ci_bitrate_auto,
+		 " Adapt CI output bitrate to the measured stream rate, starting at ci_bitrate. Can be set per port by writing 0 to obr attribute.");
+
 static int ts_loop = -1;
 module_param(ts_loop, int, 0444);
 MODULE_PARM_DESC(ts_loop, "TS in/out test loop on port ts_loop");
@@ -309,7 +314,7 @@ static int ddb_redirect(u32 i, u32 p)
 /****************************************************************************/
 /****************************************************************************/
 
-static void dma_free(struct pci_dev *pdev, struct ddb_dma *dma, int dir)
+static void dma_free(struct device *ddev, struct ddb_dma *dma, int dir)
 {
 	int i;
 
@@ -318,13 +323,13 @@ static void dma_free(struct pci_dev *pdev, struct ddb_dma *dma, int dir)
 	for (i = 0; i < dma->num; i++) {
 		if (dma->vbuf[i]) {
 			if (alt_dma) {
-				dma_unmap_single(&pdev->dev, dma->pbuf[i],
+				dma_unmap_single(ddev, dma->pbuf[i],
 						 dma->size,
 						 dir ? DMA_TO_DEVICE :
 						 DMA_BIDIRECTIONAL);
 				kfree(dma->vbuf[i]);
 			} else {
-				dma_free_coherent(&pdev->dev, dma->size,
+				dma_free_coherent(ddev, dma->size,
 						  dma->vbuf[i],
 						  dma->pbuf[i]);
 			}
@@ -333,7 +338,7 @@ static void dma_free(struct pci_dev *pdev, struct ddb_dma *dma, int dir)
 	}
 }
 
-static int dma_alloc(struct pci_dev *pdev, struct ddb_dma *dma, int dir)
+static int dma_alloc(struct device *ddev, struct ddb_dma *dma, int dir)
 {
 	int i;
 
@@ -348,18 +353,18 @@ static int dma_alloc(struct pci_dev *pdev, struct ddb_dma *dma, int dir)
 #endif
 			if (!dma->vbuf[i])
 				return -ENOMEM;
-			dma->pbuf[i] = dma_map_single(&pdev->dev,
+			dma->pbuf[i] = dma_map_single(ddev,
 						      dma->vbuf[i],
 						      dma->size,
 						      dir ? DMA_TO_DEVICE :
 						      DMA_BIDIRECTIONAL);
-			if (dma_mapping_error(&pdev->dev, dma->pbuf[i])) {
+			if (dma_mapping_error(ddev, dma->pbuf[i])) {
 				kfree(dma->vbuf[i]);
 				dma->vbuf[i] = 0;
 				return -ENOMEM;
 			}
 		} else {
-			dma->vbuf[i] = dma_alloc_coherent(&pdev->dev,
+			dma->vbuf[i] = dma_alloc_coherent(ddev,
 							  dma->size,
 							  &dma->pbuf[i],
 							  GFP_KERNEL | __GFP_ZERO);
@@ -367,7 +372,7 @@ static int dma_alloc(struct pci_dev *pdev, struct ddb_dma *dma, int dir)
 				return -ENOMEM;
 		}
 		if (((uintptr_t) dma->vbuf[i] & 0xfff))
-			dev_err(&pdev->dev, "DMA memory at %px not aligned!\n", dma->vbuf[i]);
+			dev_err(ddev, "DMA memory at %px not aligned!\n", dma->vbuf[i]);
 	}
 	return 0;
 }
@@ -382,24 +387,24 @@ static int ddb_buffers_alloc(struct ddb *dev)
 		switch (port->class) {
 		case DDB_PORT_TUNER:
 			if (port->input[0]->dma)
-				if (dma_alloc(dev->pdev,
+				if (dma_alloc(dev->dev,
 					      port->input[0]->dma, 0) < 0)
 					return -1;
 			if (port->input[1]->dma)
-				if (dma_alloc(dev->pdev,
+				if (dma_alloc(dev->dev,
 					      port->input[1]->dma, 0) < 0)
 					return -1;
 			break;
 		case DDB_PORT_CI:
 		case DDB_PORT_LOOP:
 			if (port->input[0]->dma)
-				if (dma_alloc(dev->pdev,
+				if (dma_alloc(dev->dev,
 					      port->input[0]->dma, 0) < 0)
 					return -1;
 			fallthrough;
 		case DDB_PORT_MOD:
 			if (port->output->dma)
-				if (dma_alloc(dev->pdev,
+				if (dma_alloc(dev->dev,
 					      port->output->dma, 1) < 0)
 					return -1;
 			break;
@@ -420,11 +425,11 @@ void ddb_buffers_free(struct ddb *dev)
 		port = &dev->port[i];
 
 		if (port->input[0] && port->input[0]->dma)
-			dma_free(dev->pdev, port->input[0]->dma, 0);
+			dma_free(dev->dev, port->input[0]->dma, 0);
 		if (port->input[1] && port->input[1]->dma)
-			dma_free(dev->pdev, port->input[1]->dma, 0);
+			dma_free(dev->dev, port->input[1]->dma, 0);
 		if (port->output && port->output->dma)
-			dma_free(dev->pdev, port->output->dma, 1);
+			dma_free(dev->dev, port->output->dma, 1);
 	}
 }
 
@@ -454,7 +459,8 @@ void ddb_buffers_free(struct ddb *dev)
 static void calc_con(struct ddb_output *output, u32 *con, u32 *con2, u32 flags)
 {
 	struct ddb *dev = output->port->dev;
-	u32 bitrate = output->port->obr, max_bitrate = 72000;
+	u32 bitrate = output->port->obr ? output->port->obr : output->port->aobr;
+	u32 max_bitrate = 72000;
 	u32 gap = 4, nco = 0;
 
 	*con = 0x1C;
@@ -527,6 +533,9 @@ static int ddb_output_start_unlocked(struct ddb_output *output)
 		output->dma->cbuf = 0;
 		output->dma->coff = 0;
 		output->dma->stat = 0;
+		output->dma->rate_fill = 0;
+		output->dma->rate_pos = 0;
+		output->dma->rate_jiffies = jiffies;
 		ddbwritel(dev, 0, DMA_BUFFER_CONTROL(output->dma));
 	}
 	if (output->port->class == DDB_PORT_MOD) {
@@ -553,8 +562,11 @@ static int ddb_output_start_unlocked(struct ddb_output *output)
 	}
 	if (output->port->class != DDB_PORT_MOD)
 		ddbwritel(dev, con | 1, TS_CONTROL(output));
-	if (output->dma)
+	if (output->dma) {
 		output->dma->running = 1;
+		if (output->port->class == DDB_PORT_CI)
+			queue_delayed_work(ddb_wq, &output->dma->rate_work, HZ);
+	}
 	return err;
 }
 
@@ -594,6 +606,7 @@ static void ddb_output_stop(struct ddb_output *output)
 		spin_lock_irq(&output->dma->lock);
 		ddb_output_stop_unlocked(output);
 		spin_unlock_irq(&output->dma->lock);
+		cancel_delayed_work_sync(&output->dma->rate_work);
 	} else {
 		ddb_output_stop_unlocked(output);
 	}
@@ -655,6 +668,7 @@ static void ddb_input_start_unlocked(struct ddb_input *input)
 		input->dma->stat = 0;
 		input->dma->stall_count = 0;
 		input->dma->packet_loss = 0;
+		input->dma->bidx = 0;
 		ddbwritel(dev, 0, DMA_BUFFER_CONTROL(input->dma));
 	}
 	ddbwritel(dev, 0, TS_CONTROL(input));
@@ -762,9 +776,36 @@ static u32 ddb_output_free(struct ddb_output *output)
 	return 0;
 }
 
+/*
+ * Copy helpers for the ts/mod devices. With an iov_iter (read_iter,
+ * write_iter and thereby splice) data moves between the DMA buffers and
+ * kernel pages directly, otherwise from or to the user buffer.
+ */
+static int ddb_copy_from(void *dst, const __user u8 *buf,
+			 struct iov_iter *from, u32 len)
+{
+#if (KERNEL_VERSION(4, 9, 0) <= LINUX_VERSION_CODE)
+	if (from)
+		return copy_from_iter(dst, len, from) == len ? 0 : -EFAULT;
+#endif
+	return copy_from_user(dst, buf, len) ? -EIO : 0;
+}
+
+static int ddb_copy_to(__user u8 *buf, struct iov_iter *to,
+		       const void *src, u32 len)
+{
+#if (KERNEL_VERSION(4, 9, 0) <= LINUX_VERSION_CODE)
+	if (to)
+		return copy_to_iter(src, len, to) == len ? 0 : -EFAULT;
+#endif
+	return copy_to_user(buf, src, len) ? -EFAULT : 0;
+}
+
 static ssize_t ddb_output_write(struct ddb_output *output,
-				const __user u8 *buf, size_t count)
+				const __user u8 *buf, struct iov_iter *from,
+				size_t count)
 {
+	int ret;
 	struct ddb *dev = output->port->dev;
 	u32 idx, off, stat = output->dma->stat;
 	u32 left = count, len;
@@ -797,18 +838,19 @@ static ssize_t ddb_output_write(struct ddb_output *output,
 							output->dma->cbuf],
 						output->dma->size,
 						DMA_TO_DEVICE);
-		if (copy_from_user(output->dma->vbuf[output->dma->cbuf] +
-				   output->dma->coff,
-				   buf, len))
-			return -EIO;
+		ret = ddb_copy_from(output->dma->vbuf[output->dma->cbuf] +
+				    output->dma->coff, buf, from, len);
 		if (alt_dma)
 			dma_sync_single_for_device(dev->dev,
 						   output->dma->pbuf[
 							   output->dma->cbuf],
 						   output->dma->size,
 						   DMA_TO_DEVICE);
+		if (ret)
+			return ret;
 		left -= len;
 		buf += len;
+		output->dma->rate_fill += len;
 		output->dma->coff += len;
 		if (output->dma->coff == output->dma->size) {
 			output->dma->coff = 0;
@@ -843,7 +885,7 @@ static u32 ddb_input_avail(struct ddb_input *input)
 }
 
 static size_t ddb_input_read(struct ddb_input *input,
-			     __user u8 *buf, size_t count)
+			     __user u8 *buf, struct iov_iter *to, size_t count)
 {
 	struct ddb *dev = input->port->dev;
 	u32 left = count;
@@ -865,8 +907,8 @@ static size_t ddb_input_read(struct ddb_input *input,
 							input->dma->cbuf],
 						input->dma->size,
 						DMA_FROM_DEVICE);
-		ret = copy_to_user(buf, input->dma->vbuf[input->dma->cbuf] +
-				   input->dma->coff, free);
+		ret = ddb_copy_to(buf, to, input->dma->vbuf[input->dma->cbuf] +
+				  input->dma->coff, free);
 		if (alt_dma)
 			dma_sync_single_for_device(dev->dev,
 						   input->dma->pbuf[
@@ -874,7 +916,7 @@ static size_t ddb_input_read(struct ddb_input *input,
 						   input->dma->size,
 						   DMA_FROM_DEVICE);
 		if (ret)
-			return -EFAULT;
+			return ret;
 		input->dma->coff += free;
 		if (input->dma->coff == input->dma->size) {
 			input->dma->coff = 0;
@@ -893,8 +935,8 @@ static size_t ddb_input_read(struct ddb_input *input,
 /****************************************************************************/
 /****************************************************************************/
 
-static ssize_t ts_write(struct file *file, const char *buf,
-			size_t count, loff_t *ppos)
+static ssize_t ts_do_write(struct file *file, const char *buf,
+			   struct iov_iter *from, size_t count)
 {
 	struct dvb_device *dvbdev = file->private_data;
 	struct ddb_output *output = dvbdev->priv;
@@ -913,7 +955,7 @@ static ssize_t ts_write(struct file *file, const char *buf,
 				    ddb_output_free(output) >= 188) < 0)
 				break;
 		}
-		stat = ddb_output_write(output, buf, left);
+		stat = ddb_output_write(output, buf, from, left);
 		if (stat < 0)
 			return stat;
 		buf += stat;
@@ -922,8 +964,14 @@ static ssize_t ts_write(struct file *file, const char *buf,
 	return (left == count) ? -EAGAIN : (count - left);
 }
 
-static ssize_t ts_read(struct file *file, __user char *buf,
-		       size_t count, loff_t *ppos)
+static ssize_t ts_write(struct file *file, const char *buf,
+			size_t count, loff_t *ppos)
+{
+	return ts_do_write(file, buf, NULL, count);
+}
+
+static ssize_t ts_do_read(struct file *file, __user char *buf,
+			  struct iov_iter *to, size_t count)
 {
 	struct dvb_device *dvbdev = file->private_data;
 	struct ddb_output *output = dvbdev->priv;
@@ -945,7 +993,7 @@ static ssize_t ts_read(struct file *file, __user char *buf,
 				    ddb_input_avail(input) >= 188) < 0)
 				break;
 		}
-		stat = ddb_input_read(input, buf, left);
+		stat = ddb_input_read(input, buf, to, left);
 		if (stat < 0)
 			return stat;
 		left -= stat;
@@ -954,6 +1002,24 @@ static ssize_t ts_read(struct file *file, __user char *buf,
 	return (count && (left == count)) ? -EAGAIN : (count - left);
 }
 
+static ssize_t ts_read(struct file *file, __user char *buf,
+		       size_t count, loff_t *ppos)
+{
+	return ts_do_read(file, buf, NULL, count);
+}
+
+#if (KERNEL_VERSION(4, 9, 0) <= LINUX_VERSION_CODE)
+static ssize_t ts_read_iter(struct kiocb *iocb, struct iov_iter *to)
+{
+	return ts_do_read(iocb->ki_filp, NULL, to, iov_iter_count(to));
+}
+
+static ssize_t ts_write_iter(struct kiocb *iocb, struct iov_iter *from)
+{
+	return ts_do_write(iocb->ki_filp, NULL, from, iov_iter_count(from));
+}
+#endif
+
 static unsigned int ts_poll(struct file *file, poll_table *wait)
 {
 	struct dvb_device *dvbdev = file->private_data;
@@ -1063,6 +1129,16 @@ static const struct file_operations ci_fops = {
 	.release = ts_release,
 	.poll    = ts_poll,
 	.mmap    = NULL,
+#if (KERNEL_VERSION(4, 9, 0) <= LINUX_VERSION_CODE)
+	.read_iter    = ts_read_iter,
+	.write_iter   = ts_write_iter,
+#if (KERNEL_VERSION(6, 5, 0) <= LINUX_VERSION_CODE)
+	.splice_read  = copy_splice_read,
+#else
+	.splice_read  = generic_file_splice_read,
+#endif
+	.splice_write = iter_file_splice_write,
+#endif
 };
 
 static struct dvb_device dvbdev_ci = {
@@ -1095,6 +1171,16 @@ static const struct file_operations mod_fops = {
 	.poll    = ts_poll,
 	.mmap    = NULL,
 	.unlocked_ioctl = mod_ioctl,
+#if (KERNEL_VERSION(4, 9, 0) <= LINUX_VERSION_CODE)
+	.read_iter    = ts_read_iter,
+	.write_iter   = ts_write_iter,
+#if (KERNEL_VERSION(6, 5, 0) <= LINUX_VERSION_CODE)
+	.splice_read  = copy_splice_read,
+#else
+	.splice_read  = generic_file_splice_read,
+#endif
+	.splice_write = iter_file_splice_write,
+#endif
 };
 
 static struct dvb_device dvbdev_mod = {
@@ -2097,6 +2183,14 @@ static void ddb_port_probe(struct ddb_port *port)
 
 	/* Handle missing ports and ports without I2C */
 
+	if (ddb_is_sim(dev)) {
+		port->name = "DUMMY";
+		port->class = DDB_PORT_TUNER;
+		port->type = DDB_TUNER_DUMMY;
+		port->type_name = "DUMMY";
+		return;
+	}
+
 	if (dummy_tuner && !port->nr &&
 	    (link->ids.device == 0x0005 ||
 	     link->ids.device == 0x000a)) {
@@ -2367,10 +2461,17 @@ void ddb_ports_detach(struct ddb *dev)
 static void input_write_output(struct ddb_input *input,
 			       struct ddb_output *output)
 {
+	struct ddb_dma *dma = output->dma;
+	u32 total = dma->num * dma->size;
+	u32 cbuf = (input->dma->stat >> 11) & 0x1f;
+	u32 coff = (input->dma->stat & 0x7ff) << 7;
+
 	ddbwritel(output->port->dev,
-		  input->dma->stat, DMA_BUFFER_ACK(output->dma));
-	output->dma->cbuf = (input->dma->stat >> 11) & 0x1f;
-	output->dma->coff = (input->dma->stat & 0x7ff) << 7;
+		  input->dma->stat, DMA_BUFFER_ACK(dma));
+	dma->rate_fill += (cbuf * dma->size + coff + total -
+			   dma->cbuf * dma->size - dma->coff) % total;
+	dma->cbuf = cbuf;
+	dma->coff = coff;
 }
 
 static void output_ack_input(struct ddb_output *output,
@@ -2380,6 +2481,27 @@ static void output_ack_input(struct ddb_output *output,
 		  output->dma->stat, DMA_BUFFER_ACK(input->dma));
 }
 
+/*
+ * Stamp the blocks completed up to stat with the time their completion
+ * was first seen. This is normally the interrupt, but blocks which
+ * input_write_dvb() finds before their interrupt was handled are
+ * stamped there. stamp_lock is separate from dma->lock, which the work
+ * holds for the whole demux run.
+ */
+static void input_stamp(struct ddb_dma *dma, u32 stat)
+{
+	u32 idx = (stat >> 11) & 0x1f;
+	u64 now = ktime_to_ns(ktime_get());
+	unsigned long flags;
+
+	spin_lock_irqsave(&dma->stamp_lock, flags);
+	while (dma->bidx != idx) {
+		dma->btime[dma->bidx] = now;
+		dma->bidx = (dma->bidx + 1) % dma->num;
+	}
+	spin_unlock_irqrestore(&dma->stamp_lock, flags);
+}
+
 static void input_write_dvb(struct ddb_input *input,
 			    struct ddb_input *input2)
 {
@@ -2405,6 +2527,9 @@ static void input_write_dvb(struct ddb_input *input,
 		if (alt_dma)
 			dma_sync_single_for_cpu(dev->dev, dma2->pbuf[dma->cbuf],
 						dma2->size, DMA_FROM_DEVICE);
+#ifndef KERNEL_DVB_CORE
+		dvb->demux.dmx.block_time = dma->btime[dma->cbuf];
+#endif
 		if (raw_stream || input->con) {
 			dvb_dmx_swfilter_raw(&dvb->demux,
 					     dma2->vbuf[dma->cbuf],
@@ -2437,7 +2562,11 @@ static void input_write_dvb(struct ddb_input *input,
 				  DMA_BUFFER_ACK(dma));
 		dma->stat = ddbreadl(dev, DMA_BUFFER_CURRENT(dma));
 		dma->ctrl = ddbreadl(dev, DMA_BUFFER_CONTROL(dma));
+		input_stamp(dma, dma->stat);
 	}
+#ifndef KERNEL_DVB_CORE
+	dvb->demux.dmx.block_time = 0;
+#endif
 }
 
 static void input_proc(struct ddb_dma *dma)
@@ -2473,6 +2602,7 @@ static void input_handler(void *data)
 	struct ddb_input *input = (struct ddb_input *) data;
 	struct ddb_dma *dma = input->dma;
 
+	input_stamp(dma, ddbreadl(input->port->dev, DMA_BUFFER_CURRENT(dma)));
 	/* If there is no input connected, input_proc() will
 	 * just copy pointers and ACK. So, there is no need to go
 	 * through the workqueue scheduler.
@@ -2487,6 +2617,86 @@ static void input_handler(void *data)
 		queue_work(ddb_wq, &dma->work);
 }
 
+#define CI_AUTO_MIN_BITRATE 31000
+
+/*
+ * Switch the CI clock to a new automatic bitrate. TS_CONTROL2 only holds
+ * the rate field (NCO increment or gap length, see calc_con()) and no
+ * state of the packet engine, so it is rewritten while the output runs.
+ * If the mode bits in TS_CONTROL change as well (NCO on or off, 96 MBit/s,
+ * gap enable), the output goes through the same reset sequence as in
+ * ddb_output_start_unlocked() before it is enabled with the new mode.
+ */
+static void output_set_aobr(struct ddb_output *output, u32 bitrate)
+{
+	struct ddb *dev = output->port->dev;
+	u32 ocon, ocon2, con, con2;
+
+	calc_con(output, &ocon, &ocon2, 0);
+	output->port->aobr = bitrate;
+	calc_con(output, &con, &con2, 0);
+	if (con == ocon) {
+		ddbwritel(dev, con2, TS_CONTROL2(output));
+		return;
+	}
+	ddbwritel(dev, 0, TS_CONTROL(output));
+	ddbwritel(dev, 2, TS_CONTROL(output));
+	ddbwritel(dev, 0, TS_CONTROL(output));
+	ddbwritel(dev, con, TS_CONTROL(output));
+	ddbwritel(dev, con2, TS_CONTROL2(output));
+	ddbwritel(dev, con | 1, TS_CONTROL(output));
+}
+
+/*
+ * Once a second, in automatic mode, choose the lowest CI clock which
+ * still carries the incoming stream with 25% headroom. The stream is
+ * counted where it enters the output ring, in ddb_output_write() for the
+ * ci device and in input_write_output() for the paired input of a
+ * redirect, because the drain rate of the output DMA is capped by the
+ * current clock. A ring which is more than 3/4 full, or a stream at more
+ * than 90% of the clock, raises the clock by 50%. This runs from a work
+ * and not from the output interrupt, so idle or stalled outputs adapt too.
+ */
+static void output_rate_work(struct work_struct *work)
+{
+	struct ddb_dma *dma = container_of(to_delayed_work(work),
+					   struct ddb_dma, rate_work);
+	struct ddb_output *output = (struct ddb_output *)dma->io;
+	struct ddb_port *port = output->port;
+	u32 total = dma->num * dma->size;
+	u32 cnt, stat, level, rate, bitrate = 0;
+	unsigned long dt;
+
+	spin_lock_irq(&dma->lock);
+	if (!dma->running) {
+		spin_unlock_irq(&dma->lock);
+		return;
+	}
+	cnt = READ_ONCE(dma->rate_fill);
+	dt = jiffies - dma->rate_jiffies;
+	if (!dt)
+		dt = 1;
+	rate = (u32)div_u64((u64)(cnt - dma->rate_pos) * 8 * HZ, dt * 1000);
+	dma->rate_pos = cnt;
+	dma->rate_jiffies = jiffies;
+	stat = ddbreadl(port->dev, DMA_BUFFER_CURRENT(dma));
+	level = (dma->cbuf * dma->size + dma->coff + total -
+		 ((stat >> 11) & 0x1f) * dma->size -
+		 ((stat & 0x7ff) << 7)) % total;
+
+	if (port->obr || port->input[0]->port->class == DDB_PORT_LOOP)
+		bitrate = 0;
+	else if (level * 4 > total * 3 || rate * 10 >= port->aobr * 9)
+		bitrate = min_t(u32, port->aobr * 3 / 2, 72000);
+	else if (rate * 8 < port->aobr * 5)
+		bitrate = max_t(u32, roundup(rate * 5 / 4, 1000),
+				CI_AUTO_MIN_BITRATE);
+	if (bitrate && bitrate != port->aobr)
+		output_set_aobr(output, bitrate);
+	queue_delayed_work(ddb_wq, &dma->rate_work, HZ);
+	spin_unlock_irq(&dma->lock);
+}
+
 static void output_handler(void *data)
 {
 	struct ddb_output *output = (struct ddb_output *)data;
@@ -2530,8 +2740,10 @@ static void ddb_dma_init(struct ddb_io *io, int nr, int out, int irq_nr)
 	io->dma = dma;
 	dma->io = io;
 	spin_lock_init(&dma->lock);
+	spin_lock_init(&dma->stamp_lock);
 	init_waitqueue_head(&dma->wq);
 	if (out) {
+		INIT_DELAYED_WORK(&dma->rate_work, output_rate_work);
 		dma->regs = rm->odma->base + rm->odma->size * nr;
 		dma->bufregs = rm->odma_buf->base + rm->odma_buf->size * nr;
 		if (io->port->dev->link[0].info->type == DDB_MOD &&
@@ -2656,7 +2868,8 @@ static void ddb_ports_init(struct ddb *dev)
 			port->lnr = l;
 			port->pnr = p;
 			port->gap = 0xffffffff;
-			port->obr = ci_bitrate;
+			port->obr = ci_bitrate_auto ? 0 : ci_bitrate;
+			port->aobr = ci_bitrate;
 			mutex_init(&port->i2c_gate_lock);
 			if (!ddb_port_match_i2c(port))
 				if (info->type == DDB_OCTOPUS_MAX)
@@ -2749,6 +2962,8 @@ void ddb_ports_release(struct ddb *dev)
 			cancel_work_sync(&port->input[1]->dma->work);
 		//if (port->output && port->output->dma)
 		//	cancel_work_sync(&port->output->dma->work);
+		if (port->output && port->output->dma)
+			cancel_delayed_work_sync(&port->output->dma->rate_work);
 	}
 }
 
@@ -2857,6 +3072,48 @@ irqreturn_t ddb_irq_handler(int irq, void *dev_id)
 	return ret;
 }
 
+/* handler for one of several MSI vectors, serves the bits routed to it */
+irqreturn_t ddb_irq_handler_vec(int irq, void *dev_id)
+{
+	struct ddb_msi_vec *vec = (struct ddb_msi_vec *)dev_id;
+	struct ddb *dev = vec->dev;
+	u32 mask = vec->mask | 0x80000000;
+	u32 s = mask & ddbreadl(dev, INTERRUPT_STATUS);
+
+	if (!s)
+		return IRQ_NONE;
+	do {
+		if (s & 0x80000000)
+			return IRQ_NONE;
+		ddbwritel(dev, s, INTERRUPT_ACK);
+		if (s & DDB_IRQ_VEC_MSG)
+			irq_handle_msg(dev, s);
+		if (s & ~DDB_IRQ_VEC_MSG)
+			irq_handle_io(dev, s);
+	} while ((s = mask & ddbreadl(dev, INTERRUPT_STATUS)));
+
+	return IRQ_HANDLED;
+}
+
+/* write the routing of interrupt bits in dev->irq_vec to the MSI enables */
+void ddb_irq_vec_update(struct ddb *dev)
+{
+	u32 mask[DDB_MAX_MSI] = { 0 };
+	int i;
+
+	for (i = 0; i < 32; i++)
+		if ((DDB_IRQ_VEC_MSG | DDB_IRQ_VEC_IO) & (1UL << i))
+			mask[dev->irq_vec[i]] |= (1UL << i);
+	/* remove moved bits from their old vector before enabling them */
+	for (i = 0; i < dev->msi; i++)
+		ddbwritel(dev, mask[i] & dev->msi_vec[i].mask,
+			  MSI0_ENABLE + 4 * i);
+	for (i = 0; i < dev->msi; i++) {
+		dev->msi_vec[i].mask = mask[i];
+		ddbwritel(dev, mask[i], MSI0_ENABLE + 4 * i);
+	}
+}
+
 static irqreturn_t irq_handle_v2_n(struct ddb *dev, u32 n)
 {
 	u32 reg = INTERRUPT_V2_STATUS + 4 * n;
@@ -2902,20 +3159,104 @@ irqreturn_t ddb_irq_handler_v2(int irq, void *dev_id)
 /****************************************************************************/
 /****************************************************************************/
 
+static struct ddb_nsd_req *nsd_find_done(struct ddb *dev, struct file *file)
+{
+	struct ddb_nsd_req *req;
+
+	list_for_each_entry(req, &dev->nsd_done, list)
+		if (req->file == file)
+			return req;
+	return NULL;
+}
+
+static int nsd_done_avail(struct ddb *dev, struct file *file)
+{
+	int avail;
+
+	spin_lock(&dev->nsd_dlock);
+	avail = !!nsd_find_done(dev, file);
+	spin_unlock(&dev->nsd_dlock);
+	return avail;
+}
+
 static ssize_t nsd_read(struct file *file, char *buf,
 			size_t count, loff_t *ppos)
 {
-	return 0;
+	struct dvb_device *dvbdev = file->private_data;
+	struct ddb *dev = dvbdev->priv;
+	struct ddb_nsd_req *req;
+	ssize_t len;
+
+	if (count < offsetof(struct dvb_nsd_result, data))
+		return -EINVAL;
+	while (1) {
+		spin_lock(&dev->nsd_dlock);
+		req = nsd_find_done(dev, file);
+		if (req) {
+			list_del(&req->list);
+			break;
+		}
+		spin_unlock(&dev->nsd_dlock);
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		if (wait_event_interruptible(dev->nsd_wq,
+					     nsd_done_avail(dev, file)) < 0)
+			return -ERESTARTSYS;
+	}
+	spin_unlock(&dev->nsd_dlock);
+
+	len = offsetof(struct dvb_nsd_result, data) + req->res.len;
+	if (len > (ssize_t)count)
+		len = count;
+	if (copy_to_user(buf, &req->res, len))
+		len = -EFAULT;
+	kfree(req);
+	return len;
 }
 
 static unsigned int nsd_poll(struct file *file, poll_table *wait)
 {
+	struct dvb_device *dvbdev = file->private_data;
+	struct ddb *dev = dvbdev->priv;
+
+	poll_wait(file, &dev->nsd_wq, wait);
+	if (nsd_done_avail(dev, file))
+		return POLLIN | POLLRDNORM;
 	return 0;
 }
 
 static int nsd_release(struct inode *inode, struct file *file)
 {
-	return dvb_generic_release(inode, file);
+	struct dvb_device *dvbdev = file->private_data;
+	struct ddb *dev = dvbdev->priv;
+	struct ddb_nsd_req *req, *next;
+	int ret;
+
+	mutex_lock(&dev->nsd_lock);
+	list_for_each_entry_safe(req, next, &dev->nsd_queue, list) {
+		if (req->file != file)
+			continue;
+		list_del(&req->list);
+		kfree(req);
+	}
+	spin_lock(&dev->nsd_dlock);
+	list_for_each_entry_safe(req, next, &dev->nsd_done, list) {
+		if (req->file != file)
+			continue;
+		list_del(&req->list);
+		kfree(req);
+	}
+	spin_unlock(&dev->nsd_dlock);
+	/* a running capture is finished by nsd_work() and dropped there */
+	if (dev->nsd_cur && dev->nsd_cur->file == file)
+		dev->nsd_cur->file = NULL;
+	if (dev->nsd_single == file)
+		dev->nsd_single = NULL;
+	mutex_unlock(&dev->nsd_lock);
+	/* ddb_nsd_detach() waits for users to drop back */
+	ret = dvb_generic_release(inode, file);
+	wake_up(&dvbdev->wait_queue);
+	return ret;
 }
 
 static int nsd_open(struct inode *inode, struct file *file)
@@ -2939,11 +3280,165 @@ static struct ddb_input *plugtoinput(struct ddb *dev, u8 plug)
 	return 0;
 }
 
-static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
+static void nsd_capture_start(struct ddb *dev, struct ddb_input *input,
+			      struct dvb_nsd_ts *ts)
 {
-	struct dvb_device *dvbdev = file->private_data;
-	struct ddb *dev = dvbdev->priv;
+	u32 ctrl, to;
+
+	ctrl = (input->port->lnr << 16) | ((input->nr & 7) << 8) |
+		((ts->filter_mask & 3) << 2);
+	ddbwritel(dev, ctrl, TS_CAPTURE_CONTROL);
+	ddbwritel(dev, ts->pid, TS_CAPTURE_PID);
+	ddbwritel(dev, (ts->section_id << 16) |
+		  (ts->table << 8) | ts->section,
+		  TS_CAPTURE_TABLESECTION);
+	/* 1024 ms default timeout if timeout set to 0 */
+	if (ts->timeout)
+		to = ts->timeout;
+	else
+		to = 1024;
+	/* 21 packets default if num set to 0 */
+	if (ts->num)
+		to |= ((u32)ts->num << 16);
+	else
+		to |= (21 << 16);
+	ddbwritel(dev, to, TS_CAPTURE_TIMEOUT);
+	if (ts->mode)
+		ctrl |= 2;
+	ddbwritel(dev, ctrl | 1, TS_CAPTURE_CONTROL);
+}
+
+/*
+ * Run the queued captures one after the other on the single capture
+ * unit. There is no capture interrupt, so the unit is checked every
+ * NSD_POLL_MS while a capture runs. A capture which does not end within
+ * its timeout plus one second is canceled.
+ */
+#define NSD_POLL_MS 5
+
+static void nsd_work(struct work_struct *work)
+{
+	struct ddb *dev = container_of(work, struct ddb, nsd_work.work);
+	struct ddb_nsd_req *req;
+	u32 ctrl, to;
+
+	mutex_lock(&dev->nsd_lock);
+	req = dev->nsd_cur;
+	ctrl = ddbreadl(dev, TS_CAPTURE_CONTROL);
+	if (req) {
+		to = req->ts.timeout ? req->ts.timeout : 1024;
+		if (ctrl & 1) {
+			if (time_before(jiffies, dev->nsd_start +
+					msecs_to_jiffies(to + 1000)))
+				goto resched;
+			ddbwritel(dev, 0, TS_CAPTURE_CONTROL);
+			req->res.status = -ETIMEDOUT;
+		} else if (ctrl & (1 << 14)) {
+			req->res.status = -ETIMEDOUT;
+		} else {
+			req->res.len = ddbreadl(dev, TS_CAPTURE_RECEIVED) &
+				0x1fff;
+			if (req->res.len > TS_CAPTURE_LEN)
+				req->res.len = TS_CAPTURE_LEN;
+			ddbcpyfrom(dev, req->res.data, TS_CAPTURE_MEMORY,
+				   req->res.len);
+		}
+		ddb_dvb_ns_input_stop(req->input);
+		dev->nsd_cur = NULL;
+		if (req->file) {
+			spin_lock(&dev->nsd_dlock);
+			list_add_tail(&req->list, &dev->nsd_done);
+			spin_unlock(&dev->nsd_dlock);
+			wake_up_interruptible(&dev->nsd_wq);
+		} else {
+			kfree(req);
+		}
+		ctrl = 0;
+	}
+	if (list_empty(&dev->nsd_queue))
+		goto out;
+	/* capture unit used through NSD_START_GET_TS until its result
+	 * was fetched or the capture was canceled
+	 */
+	if ((ctrl & 1) || dev->nsd_single)
+		goto resched;
+	req = list_first_entry(&dev->nsd_queue, struct ddb_nsd_req, list);
+	list_del(&req->list);
+	dev->nsd_cur = req;
+	dev->nsd_start = jiffies;
+	ddb_dvb_ns_input_start(req->input);
+	nsd_capture_start(dev, req->input, &req->ts);
+resched:
+	queue_delayed_work(ddb_wq, &dev->nsd_work,
+			   msecs_to_jiffies(NSD_POLL_MS));
+out:
+	mutex_unlock(&dev->nsd_lock);
+}
+
+/* count requests of all files and of file, called with nsd_lock held */
+static void nsd_count(struct ddb *dev, struct file *file,
+		      u32 *all, u32 *own)
+{
+	struct ddb_nsd_req *req;
+
+	*all = *own = 0;
+	if (dev->nsd_cur) {
+		(*all)++;
+		if (dev->nsd_cur->file == file)
+			(*own)++;
+	}
+	list_for_each_entry(req, &dev->nsd_queue, list) {
+		(*all)++;
+		if (req->file == file)
+			(*own)++;
+	}
+	spin_lock(&dev->nsd_dlock);
+	list_for_each_entry(req, &dev->nsd_done, list) {
+		(*all)++;
+		if (req->file == file)
+			(*own)++;
+	}
+	spin_unlock(&dev->nsd_dlock);
+}
+
+static int nsd_queue(struct ddb *dev, struct file *file,
+		     struct dvb_nsd_ts *ts)
+{
+	struct ddb_input *input = plugtoinput(dev, ts->input);
+	struct ddb_nsd_req *req;
+	u32 all, own;
+	int id;
+
+	if (!input)
+		return -EINVAL;
+	req = kzalloc(sizeof(*req), GFP_KERNEL);
+	if (!req)
+		return -ENOMEM;
+	req->file = file;
+	req->input = input;
+	req->ts = *ts;
+	req->res.input = ts->input;
+	req->res.pid = ts->pid;
+	mutex_lock(&dev->nsd_lock);
+	nsd_count(dev, file, &all, &own);
+	if (all >= DDB_NSD_REQS || own >= DDB_NSD_FILE_REQS) {
+		mutex_unlock(&dev->nsd_lock);
+		kfree(req);
+		return -EBUSY;
+	}
+	id = ++dev->nsd_id & 0x7fffffff;
+	req->res.id = id;
+	list_add_tail(&req->list, &dev->nsd_queue);
+	if (!dev->nsd_cur)
+		mod_delayed_work(ddb_wq, &dev->nsd_work, 0);
+	mutex_unlock(&dev->nsd_lock);
+	return id;
+}
 
+/* single capture interface, called with nsd_lock held */
+static int nsd_single_ioctl(struct ddb *dev, struct file *file,
+			    unsigned int cmd, void *parg)
+{
 	/* unsigned long arg = (unsigned long)parg; */
 	int ret = 0;
 
@@ -2952,39 +3447,17 @@ static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
 	{
 		struct dvb_nsd_ts *ts = parg;
 		struct ddb_input *input = plugtoinput(dev, ts->input);
-		u32 ctrl;
-		u32 to;
 
 		if (!input)
 			return -EINVAL;
-		ctrl = (input->port->lnr << 16) | ((input->nr & 7) << 8) |
-			((ts->filter_mask & 3) << 2);
-
-		if (ddbreadl(dev, TS_CAPTURE_CONTROL) & 1) {
+		if ((dev->nsd_single && dev->nsd_single != file) ||
+		    (ddbreadl(dev, TS_CAPTURE_CONTROL) & 1)) {
 			dev_info(dev->dev, "ts capture busy\n");
 			return -EBUSY;
 		}
 		ddb_dvb_ns_input_start(input);
-
-		ddbwritel(dev, ctrl, TS_CAPTURE_CONTROL);
-		ddbwritel(dev, ts->pid, TS_CAPTURE_PID);
-		ddbwritel(dev, (ts->section_id << 16) |
-			  (ts->table << 8) | ts->section,
-			  TS_CAPTURE_TABLESECTION);
-		/* 1024 ms default timeout if timeout set to 0 */
-		if (ts->timeout)
-			to = ts->timeout;
-		else
-			to = 1024;
-		/* 21 packets default if num set to 0 */
-		if (ts->num)
-			to |= ((u32)ts->num << 16);
-		else
-			to |= (21 << 16);
-		ddbwritel(dev, to, TS_CAPTURE_TIMEOUT);
-		if (ts->mode)
-			ctrl |= 2;
-		ddbwritel(dev, ctrl | 1, TS_CAPTURE_CONTROL);
+		nsd_capture_start(dev, input, ts);
+		dev->nsd_single = file;
 		break;
 	}
 	case NSD_POLL_GET_TS:
@@ -2992,13 +3465,16 @@ static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
 		struct dvb_nsd_ts *ts = parg;
 		u32 ctrl = ddbreadl(dev, TS_CAPTURE_CONTROL);
 
-		if (ctrl & 1)
+		if ((dev->nsd_single && dev->nsd_single != file) ||
+		    (ctrl & 1))
 			return -EBUSY;
+		dev->nsd_single = NULL;
 		if (ctrl & (1 << 14))
 			return -EAGAIN;
-		ddbcpyfrom(dev, dev->tsbuf, TS_CAPTURE_MEMORY,
-			   TS_CAPTURE_LEN);
 		ts->len = ddbreadl(dev, TS_CAPTURE_RECEIVED) & 0x1fff;
+		if (ts->len > TS_CAPTURE_LEN)
+			ts->len = TS_CAPTURE_LEN;
+		ddbcpyfrom(dev, dev->tsbuf, TS_CAPTURE_MEMORY, ts->len);
 		if (copy_to_user(ts->ts, dev->tsbuf, ts->len))
 			return -EIO;
 		break;
@@ -3009,6 +3485,7 @@ static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
 
 		ddbwritel(dev, ctrl, TS_CAPTURE_CONTROL);
 		ctrl = ddbreadl(dev, TS_CAPTURE_CONTROL);
+		dev->nsd_single = NULL;
 		break;
 	}
 	case NSD_STOP_GET_TS:
@@ -3019,12 +3496,15 @@ static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
 
 		if (!input)
 			return -EINVAL;
-		if (ctrl & 1) {
+		/* a running queued capture is not ours to wait for */
+		if ((ctrl & 1) && !dev->nsd_cur) {
 			dev_info(dev->dev,
 				 "cannot stop ts capture, while it was neither finished nor canceled\n");
 			return -EBUSY;
 		}
 		ddb_dvb_ns_input_stop(input);
+		if (dev->nsd_single == file)
+			dev->nsd_single = NULL;
 		break;
 	}
 	default:
@@ -3034,6 +3514,27 @@ static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
 	return ret;
 }
 
+static int nsd_do_ioctl(struct file *file, unsigned int cmd, void *parg)
+{
+	struct dvb_device *dvbdev = file->private_data;
+	struct ddb *dev = dvbdev->priv;
+	int ret;
+
+	if (cmd == NSD_QUEUE_GET_TS)
+		return nsd_queue(dev, file, parg);
+
+	/* the capture unit belongs to the queue while it runs a request,
+	 * only the input of a finished capture can still be stopped
+	 */
+	mutex_lock(&dev->nsd_lock);
+	if (dev->nsd_cur && cmd != NSD_STOP_GET_TS)
+		ret = -EBUSY;
+	else
+		ret = nsd_single_ioctl(dev, file, cmd, parg);
+	mutex_unlock(&dev->nsd_lock);
+	return ret;
+}
+
 static long nsd_ioctl(struct file *file,
 		      unsigned int cmd, unsigned long arg)
 {
@@ -3051,9 +3552,9 @@ static const struct file_operations nsd_fops = {
 
 static struct dvb_device dvbdev_nsd = {
 	.priv    = 0,
-	.readers = 1,
-	.writers = 1,
-	.users   = 1,
+	.readers = DDB_NSD_USERS,
+	.writers = DDB_NSD_USERS,
+	.users   = DDB_NSD_USERS,
 	.fops    = &nsd_fops,
 };
 
@@ -3063,6 +3564,12 @@ static int ddb_nsd_attach(struct ddb *dev)
 
 	if (!dev->link[0].info->ns_num)
 		return 0;
+	mutex_init(&dev->nsd_lock);
+	spin_lock_init(&dev->nsd_dlock);
+	INIT_LIST_HEAD(&dev->nsd_queue);
+	INIT_LIST_HEAD(&dev->nsd_done);
+	INIT_DELAYED_WORK(&dev->nsd_work, nsd_work);
+	init_waitqueue_head(&dev->nsd_wq);
 	ret = dvb_register_device(&dev->adap[0],
 				  &dev->nsd_dev,
 				  &dvbdev_nsd, (void *)dev,
@@ -3075,11 +3582,18 @@ void ddb_nsd_detach(struct ddb *dev)
 	if (!dev->link[0].info->ns_num)
 		return;
 
-	if (dev->nsd_dev->users > 2) {
+	if (dev->nsd_dev->users < DDB_NSD_USERS) {
 		wait_event(dev->nsd_dev->wait_queue,
-			   dev->nsd_dev->users == 2);
+			   dev->nsd_dev->users == DDB_NSD_USERS);
 	}
 	dvb_unregister_device(dev->nsd_dev);
+	cancel_delayed_work_sync(&dev->nsd_work);
+	if (dev->nsd_cur) {
+		ddbwritel(dev, 0, TS_CAPTURE_CONTROL);
+		ddb_dvb_ns_input_stop(dev->nsd_cur->input);
+		kfree(dev->nsd_cur);
+		dev->nsd_cur = NULL;
+	}
 }
 
 /****************************************************************************/
@@ -3235,6 +3749,81 @@ static int ddb_open(struct inode *inode, struct file *file)
 	return 0;
 }
 
+/*
+ * Statistics of all inputs from what the frontend threads and the DMA
+ * handling have already collected, nothing is read over I2C or MCI.
+ */
+static void ddb_input_stats(struct ddb_input *input, struct ddb_fe_stats *st)
+{
+	struct ddb_dvb *dvb = &input->port->dvb[input->nr & 1];
+	struct ddb_dma *dma = input->dma;
+	struct dvb_frontend *fe = dvb->fe;
+	struct dtv_frontend_properties *c;
+	unsigned long flags;
+
+	memset(st, 0, sizeof(*st));
+	st->link = input->port->lnr;
+	st->port = input->port->nr;
+	st->input = input->nr;
+	if (fe && dvb->attached >= 0x40) {
+		c = &fe->dtv_property_cache;
+		st->flags |= DDB_FE_STATS_FE;
+#ifndef KERNEL_DVB_CORE
+		st->status = dvb_frontend_cached_status(fe);
+		st->flags |= DDB_FE_STATS_STATUS;
+#endif
+		st->strength_scale = c->strength.stat[0].scale;
+		st->strength = c->strength.stat[0].svalue;
+		st->cnr_scale = c->cnr.stat[0].scale;
+		st->cnr = c->cnr.stat[0].svalue;
+		st->post_bit_error = c->post_bit_error.stat[0].uvalue;
+		st->post_bit_count = c->post_bit_count.stat[0].uvalue;
+		st->block_error = c->block_error.stat[0].uvalue;
+		st->block_count = c->block_count.stat[0].uvalue;
+	}
+	if (dma) {
+		spin_lock_irqsave(&dma->lock, flags);
+		if (dma->running) {
+			update_loss(dma);
+			st->flags |= DDB_FE_STATS_DMA;
+		}
+		st->dma_stall = dma->stall_count;
+		st->dma_packet_loss = dma->packet_loss;
+		st->dma_unaligned = dma->unaligned;
+		spin_unlock_irqrestore(&dma->lock, flags);
+	}
+}
+
+static int ddb_get_stats(struct ddb *dev, struct ddb_stats __user *parg)
+{
+	struct ddb_stats req;
+	struct ddb_fe_stats st;
+	struct ddb_port *port;
+	u32 i, j, n = 0;
+
+	if (copy_from_user(&req, parg, sizeof(req)))
+		return -EFAULT;
+	for (i = 0; i < dev->port_num; i++) {
+		port = &dev->port[i];
+		if (port->class != DDB_PORT_TUNER)
+			continue;
+		for (j = 0; j < 2; j++) {
+			if (!port->input[j])
+				continue;
+			if (n < req.num) {
+				ddb_input_stats(port->input[j], &st);
+				if (copy_to_user(&req.stats[n], &st, sizeof(st)))
+					return -EFAULT;
+			}
+			n++;
+		}
+	}
+	req.total = n;
+	if (copy_to_user(parg, &req, sizeof(req)))
+		return -EFAULT;
+	return 0;
+}
+
 static long ddb_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 {
 	struct ddb *dev = file->private_data;
@@ -3439,6 +4028,8 @@ static long ddb_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 			return -EFAULT;
 		return res;
 	}
+	case IOCTL_DDB_GET_STATS:
+		return ddb_get_stats(dev, parg);
 	default:
 		return -ENOTTY;
 	}
@@ -3833,6 +4424,49 @@ static ssize_t redirect_store(struct device *device,
 	return count;
 }
 
+static ssize_t irqvec_show(struct device *device,
+			   struct device_attribute *attr, char *buf)
+{
+	struct ddb *dev = dev_get_drvdata(device);
+	int i, len = 0;
+
+	for (i = 0; i < 32; i++)
+		if (DDB_IRQ_VEC_IO & (1UL << i))
+			len += sprintf(buf + len, "%d:%d ", i, dev->irq_vec[i]);
+	buf[len - 1] = '\n';
+	return len;
+}
+
+static ssize_t irqvec_store(struct device *device,
+			    struct device_attribute *attr,
+			    const char *buf, size_t count)
+{
+	struct ddb *dev = dev_get_drvdata(device);
+	unsigned int irq, vec;
+
+	if (sscanf(buf, "%u %u\n", &irq, &vec) != 2)
+		return -EINVAL;
+	/* vector 1 is reserved for I2C and messages */
+	if (irq > 31 || !(DDB_IRQ_VEC_IO & (1UL << irq)) ||
+	    vec >= dev->msi || vec == 1)
+		return -EINVAL;
+	mutex_lock(&dev->mutex);
+	dev->irq_vec[irq] = vec;
+	ddb_irq_vec_update(dev);
+	mutex_unlock(&dev->mutex);
+	return count;
+}
+
+static ssize_t ldpc_show(struct device *device,
+			 struct device_attribute *attr, char *buf)
+{
+	struct ddb *dev = dev_get_drvdata(device);
+
+	if (!dev->link[0].mci_base)
+		return sprintf(buf, "none\n");
+	return ddb_sx8_ldpc_show(dev->link[0].mci_base, buf);
+}
+
 static ssize_t gap_show(struct device *device,
 			struct device_attribute *attr, char *buf)
 {
@@ -3865,6 +4499,8 @@ static ssize_t obr_show(struct device *device,
 	struct ddb *dev = dev_get_drvdata(device);
 	int num = attr->attr.name[3] - 0x30;
 
+	if (!dev->port[num].obr)
+		return sprintf(buf, "0 (%d)\n", dev->port[num].aobr);
 	return sprintf(buf, "%d\n", dev->port[num].obr);
 }
 
@@ -4063,6 +4699,14 @@ static struct device_attribute ddb_attrs_led[] = {
 	__ATTR(led3, 0664, led_show, led_store),
 };
 
+static struct device_attribute ddb_attrs_ldpc[] = {
+	__ATTR_RO(ldpc),
+};
+
+static struct device_attribute ddb_attrs_irqvec[] = {
+	__ATTR(irqvec, 0664, irqvec_show, irqvec_store),
+};
+
 static struct device_attribute ddb_attrs_fanspeed[] = {
 	__ATTR_MRO(fanspeed0, fanspeed_show),
 	__ATTR_MRO(fanspeed1, fanspeed_show),
@@ -4098,6 +4742,11 @@ static void ddb_device_attrs_del(struct ddb *dev)
 {
 	int i;
 
+	if (dev->msi > 2)
+		device_remove_file(dev->ddb_dev, &ddb_attrs_irqvec[0]);
+	if (dev->link[0].info->mci_type == DDB_TUNER_MCI_SX8)
+		device_remove_file(dev->ddb_dev, &ddb_attrs_ldpc[0]);
+
 	for (i = 0; i < 4; i++)
 		if (dev->link[i].info &&
 		    dev->link[i].info->tempmon_irq)
@@ -4162,6 +4811,12 @@ static int ddb_device_attrs_add(struct ddb *dev)
 			if (device_create_file(dev->ddb_dev,
 					       &ddb_attrs_fanspeed[i]))
 				goto fail;
+	if (dev->msi > 2)
+		if (device_create_file(dev->ddb_dev, &ddb_attrs_irqvec[0]))
+			goto fail;
+	if (dev->link[0].info->mci_type == DDB_TUNER_MCI_SX8)
+		if (device_create_file(dev->ddb_dev, &ddb_attrs_ldpc[0]))
+			goto fail;
 	return 0;
 fail:
 	return -1;
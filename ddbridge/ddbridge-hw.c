@@ -367,6 +367,15 @@ static const struct ddb_info ddb_octopus = {
 	.i2c_mask = 0x0f,
 };
 
+#ifdef CONFIG_DVB_DDBRIDGE_SIM
+static const struct ddb_info ddb_sim = {
+	.type     = DDB_OCTOPUS,
+	.name     = "Digital Devices simulated bridge",
+	.regmap   = &octopus_map,
+	.port_num = 4,
+};
+#endif
+
 static const struct ddb_info ddb_octopusv3 = {
 	.type     = DDB_OCTOPUS,
 	.name     = "Digital Devices Octopus V3 DVB adapter",
@@ -918,6 +927,11 @@ static const struct ddb_device_id ddb_device_ids[] = {
 	DDB_DEVID(0x0301, 0xffff, ddb_octonet_jse),
 	DDB_DEVID(0x0307, 0xffff, ddb_octonet_gtl),
 
+#ifdef CONFIG_DVB_DDBRIDGE_SIM
+	/* Simulated bridge, see ddbridge-sim.c */
+	DDB_DEVID(0x00fe, 0xffff, ddb_sim),
+#endif
+
 	/* PCIe devices */
 
 	/* DVB tuners and demodulators */
@@ -61,6 +61,10 @@ void ddblwritel(struct ddb_link *link, u32 val, u32 adr)
 
 u32 ddbreadl(struct ddb *dev, u32 adr)
 {
+#ifdef CONFIG_DVB_DDBRIDGE_SIM
+	if (ddb_is_sim(dev))
+		return ddb_sim_readl(dev, adr);
+#endif
 	if (unlikely(adr & 0xf0000000)) {
 		unsigned long flags;
 		u32 val, l = (adr >> DDB_LINK_SHIFT) & 3;
@@ -82,6 +86,12 @@ u32 ddbreadl(struct ddb *dev, u32 adr)
 
 void ddbwritel(struct ddb *dev, u32 val, u32 adr)
 {
+#ifdef CONFIG_DVB_DDBRIDGE_SIM
+	if (ddb_is_sim(dev)) {
+		ddb_sim_writel(dev, val, adr);
+		return;
+	}
+#endif
 	if (unlikely(adr & 0xf0000000)) {
 		unsigned long flags;
 		u32 l = (adr >> DDB_LINK_SHIFT);
@@ -57,6 +57,38 @@ struct ddb_mci_msg {
 	struct mci_result res;
 };
 
+/* cached frontend statistics and DMA counters of one input */
+struct ddb_fe_stats {
+	__u8   link;
+	__u8   port;
+	__u8   input;
+	__u8   flags;
+	__u8   strength_scale;  /* enum fecap_scale_params */
+	__u8   cnr_scale;
+	__u8   reserved[2];
+	__u32  status;          /* enum fe_status */
+	__u32  dma_stall;
+	__s64  strength;
+	__s64  cnr;
+	__u64  post_bit_error;
+	__u64  post_bit_count;
+	__u64  block_error;
+	__u64  block_count;
+	__u32  dma_packet_loss;
+	__u32  dma_unaligned;
+};
+
+#define DDB_FE_STATS_FE      0x01  /* a frontend is attached */
+#define DDB_FE_STATS_STATUS  0x02  /* status is valid */
+#define DDB_FE_STATS_DMA     0x04  /* input has a running DMA */
+
+/* num: entries in stats, total: returns the number of inputs */
+struct ddb_stats {
+	__u32  num;
+	__u32  total;
+	struct ddb_fe_stats *stats;
+};
+
 #define IOCTL_DDB_FLASHIO    _IOWR(DDB_MAGIC, 0x00, struct ddb_flashio)
 #define IOCTL_DDB_GPIO_IN    _IOWR(DDB_MAGIC, 0x01, struct ddb_gpio)
 #define IOCTL_DDB_GPIO_OUT   _IOWR(DDB_MAGIC, 0x02, struct ddb_gpio)
@@ -70,5 +102,6 @@ struct ddb_mci_msg {
 #define IOCTL_DDB_READ_I2C   _IOWR(DDB_MAGIC, 0x0a, struct ddb_i2c_msg)
 #define IOCTL_DDB_WRITE_I2C  _IOR(DDB_MAGIC, 0x0b, struct ddb_i2c_msg)
 #define IOCTL_DDB_MCI_CMD    _IOWR(DDB_MAGIC, 0x0c, struct ddb_mci_msg)
+#define IOCTL_DDB_GET_STATS  _IOWR(DDB_MAGIC, 0x0d, struct ddb_stats)
 
 #endif
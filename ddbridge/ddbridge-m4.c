@@ -50,6 +50,7 @@ static int stop(struct dvb_frontend *fe)
 	if (!state->started)
 		return -1;
 	state->started = 0;
+	state->mci.tune.valid = 0;
 	memset(&cmd, 0, sizeof(cmd));
 	cmd.command = MCI_CMD_STOP;
 	cmd.demod = state->mci.demod;
@@ -364,6 +365,8 @@ static int set_parameters(struct dvb_frontend *fe)
 	struct dtv_frontend_properties *p = &fe->dtv_property_cache;
 	enum fe_delivery_system ds = p->delivery_system;
 
+	if (state->started && ddb_mci_same_tune(&state->mci, p))
+		return 0;
 	stop(fe);
 #ifdef AUTOMODE
 	if ((link->ids.device == 0x0014 ||
@@ -416,6 +419,7 @@ static int set_parameters(struct dvb_frontend *fe)
 	if (!res) {
 		state->started = 1;
 		state->first_time_lock = 1;
+		ddb_mci_save_tune(&state->mci, p);
 	} else
 		stop(fe);
 	return res;
@@ -27,6 +27,11 @@ static int msi = 1;
 module_param(msi, int, 0444);
 MODULE_PARM_DESC(msi,
 		 " Control MSI interrupts: 0-disable, 1-enable (default)");
+
+static int msi_vectors = DDB_MAX_MSI;
+module_param(msi_vectors, int, 0444);
+MODULE_PARM_DESC(msi_vectors,
+		 " Maximum number of MSI vectors to use: 1-8, default 8");
 #endif
 
 #if (KERNEL_VERSION(4, 8, 0) > LINUX_VERSION_CODE)
@@ -98,6 +103,12 @@ static void ddb_irq_disable(struct ddb *dev)
 	} else {
 		ddbwritel(dev, 0, INTERRUPT_ENABLE);
 		ddbwritel(dev, 0, MSI1_ENABLE);
+		ddbwritel(dev, 0, MSI2_ENABLE);
+		ddbwritel(dev, 0, MSI3_ENABLE);
+		ddbwritel(dev, 0, MSI4_ENABLE);
+		ddbwritel(dev, 0, MSI5_ENABLE);
+		ddbwritel(dev, 0, MSI6_ENABLE);
+		ddbwritel(dev, 0, MSI7_ENABLE);
 	}
 }
 
@@ -116,7 +127,16 @@ static void __devexit ddb_msi_exit(struct ddb *dev)
 
 static void ddb_irq_exit(struct ddb *dev)
 {
+	int i;
+
 	ddb_irq_disable(dev);
+	if (dev->msi > 2 &&
+	    dev->link[0].info->regmap->irq_version != 2) {
+		for (i = 0; i < dev->msi; i++)
+			free_irq(pci_irq_vector(dev->pdev, i),
+				 &dev->msi_vec[i]);
+		return;
+	}
 	if (dev->msi == 2)
 		free_irq(pci_irq_vector(dev->pdev, 1), dev);
 	free_irq(pci_irq_vector(dev->pdev, 0), dev);
@@ -222,6 +242,50 @@ static int __devinit ddb_irq_init2(struct ddb *dev)
 	return stat;
 }
 
+static int __devinit ddb_msi_vec_max(void)
+{
+#if defined(CONFIG_PCI_MSI) && (KERNEL_VERSION(3, 15, 0) <= LINUX_VERSION_CODE)
+	if (msi_vectors > 2)
+		return min(msi_vectors, DDB_MAX_MSI);
+#endif
+	return 2;
+}
+
+/*
+ * With more than two vectors, vector 1 keeps I2C and messages and the
+ * TS input/output interrupts are spread round-robin over all others.
+ * The routing can be changed later through the irqvec attribute.
+ */
+static int __devinit ddb_irq_init_vec(struct ddb *dev)
+{
+	int i, stat, n = 0;
+
+	for (i = 0; i < 32; i++) {
+		if (DDB_IRQ_VEC_MSG & (1UL << i))
+			dev->irq_vec[i] = 1;
+		if (DDB_IRQ_VEC_IO & (1UL << i)) {
+			dev->irq_vec[i] = n ? n + 1 : 0;
+			n = (n + 1) % (dev->msi - 1);
+		}
+	}
+	for (i = 0; i < dev->msi; i++) {
+		dev->msi_vec[i].dev = dev;
+		dev->msi_vec[i].nr = i;
+		dev->msi_vec[i].mask = 0;
+		stat = request_irq(pci_irq_vector(dev->pdev, i),
+				   ddb_irq_handler_vec, 0, "ddbridge",
+				   (void *)&dev->msi_vec[i]);
+		if (stat < 0) {
+			while (--i >= 0)
+				free_irq(pci_irq_vector(dev->pdev, i),
+					 &dev->msi_vec[i]);
+			return stat;
+		}
+	}
+	ddb_irq_vec_update(dev);
+	return 0;
+}
+
 static int __devinit ddb_irq_init(struct ddb *dev)
 {
 	int stat;
@@ -239,8 +303,10 @@ static int __devinit ddb_irq_init(struct ddb *dev)
 	ddbwritel(dev, 0x00000000, MSI6_ENABLE);
 	ddbwritel(dev, 0x00000000, MSI7_ENABLE);
 
-	ddb_irq_msi(dev, 2);
+	ddb_irq_msi(dev, ddb_msi_vec_max());
 
+	if (dev->msi > 2)
+		return ddb_irq_init_vec(dev);
 	if (dev->msi)
 		irq_flag = 0;
 	if (dev->msi == 2) {
@@ -494,12 +560,14 @@ static __init int module_init_ddbridge(void)
 		return stat;
 	stat = pci_register_driver(&ddb_pci_driver);
 	if (stat < 0)
-		ddb_exit_ddbridge(0, stat);
+		return ddb_exit_ddbridge(0, stat);
+	ddb_sim_init();
 	return stat;
 }
 
 static __exit void module_exit_ddbridge(void)
 {
+	ddb_sim_exit();
 	pci_unregister_driver(&ddb_pci_driver);
 	ddb_exit_ddbridge(0, 0);
 }
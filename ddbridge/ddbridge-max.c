@@ -77,6 +77,17 @@ static int lnb_command(struct ddb *dev, u32 link, u32 lnb, u32 cmd)
 
 static int max_set_input(struct dvb_frontend *fe, int in);
 
+/*
+ * MCI demods skip a retune to unchanged parameters. Voltage, tone,
+ * DiSEqC and input changes select a different signal at the same IF,
+ * so the next set_parameters() has to restart the demod.
+ */
+static void max_sec_changed(struct ddb_dvb *dvb)
+{
+	if (dvb->mci)
+		dvb->mci->tune.valid = 0;
+}
+
 static int max_emulate_switch(struct dvb_frontend *fe, u8 *cmd, u32 len)
 {
 	int input;
@@ -107,6 +118,7 @@ static int max_send_master_cmd(struct dvb_frontend *fe,
 	if (fmode == 2 || fmode == 1)
 		return 0;
 
+	max_sec_changed(dvb);
 	if (fmode == 4)
 		if (!max_emulate_switch(fe, cmd->msg, cmd->msg_len))
 			return 0;
@@ -229,6 +241,7 @@ static int max_set_input_unlocked(struct dvb_frontend *fe, int in)
 		u32 bit = (1ULL << input->nr);
 		u32 obit = dev->link[port->lnr].lnb.voltage[dvb->input] & bit;
 
+		max_sec_changed(dvb);
 		dev->link[port->lnr].lnb.voltage[dvb->input] &= ~bit;
 		dvb->input = in;
 		dev->link[port->lnr].lnb.voltage[dvb->input] |= obit;
@@ -262,6 +275,8 @@ static int max_set_tone(struct dvb_frontend *fe, enum fe_sec_tone_mode tone)
 	u32 fmode = dev->link[port->lnr].lnb.fmode;
 
 	mutex_lock(&dev->link[port->lnr].lnb.lock);
+	if (dvb->tone != tone)
+		max_sec_changed(dvb);
 	dvb->tone = tone;
 	switch (fmode) {
 	default:
@@ -301,6 +316,8 @@ static int max_set_voltage(struct dvb_frontend *fe, enum fe_sec_voltage voltage)
 	u32 fmode = dev->link[port->lnr].lnb.fmode;
 
 	mutex_lock(&dev->link[port->lnr].lnb.lock);
+	if (dvb->voltage != voltage)
+		max_sec_changed(dvb);
 	dvb->voltage = voltage;
 
 	switch (fmode) {
@@ -616,6 +633,7 @@ int ddb_fe_attach_mci(struct ddb_input *input, u32 type)
 	dvb->fe->ops.diseqc_send_master_cmd = max_send_master_cmd;
 	dvb->fe->ops.diseqc_send_burst = max_send_burst;
 	dvb->fe->sec_priv = input;
+	dvb->mci = dvb->fe->demodulator_priv;
 	if (type == DDB_TUNER_MCI_SX8) {
 #ifndef KERNEL_DVB_CORE
 		dvb->fe->ops.set_input = max_set_input;
@@ -255,6 +255,42 @@ int ddb_mci_get_info(struct mci *mci)
 	return ddb_mci_cmd(mci, &mci->cmd, &mci->signal_info);
 }
 
+static void mci_get_tune(struct mci *mci, struct dtv_frontend_properties *p,
+			 struct mci_tune *t)
+{
+	memset(t, 0, sizeof(*t));
+	t->valid = 1;
+	t->tuner = mci->tuner;
+	t->delivery_system = p->delivery_system;
+	t->frequency = p->frequency;
+	t->symbol_rate = p->symbol_rate;
+	t->bandwidth_hz = p->bandwidth_hz;
+	t->modulation = p->modulation;
+	t->rolloff = p->rolloff;
+	t->stream_id = p->stream_id;
+	t->scrambling_sequence_index = p->scrambling_sequence_index;
+}
+
+void ddb_mci_save_tune(struct mci *mci, struct dtv_frontend_properties *p)
+{
+	mci_get_tune(mci, p, &mci->tune);
+}
+
+/*
+ * Returns 1 if the demod is already running with exactly these
+ * parameters and has not given up searching, so a retune can be skipped.
+ */
+int ddb_mci_same_tune(struct mci *mci, struct dtv_frontend_properties *p)
+{
+	struct mci_tune t;
+
+	if (!mci->tune.valid ||
+	    mci->signal_info.status == MCI_DEMOD_TIMEOUT)
+		return 0;
+	mci_get_tune(mci, p, &t);
+	return !memcmp(&t, &mci->tune, sizeof(t));
+}
+
 /****************************************************************************/
 /****************************************************************************/
 
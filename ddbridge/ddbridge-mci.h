@@ -1270,6 +1270,20 @@ struct mci_base {
 	int                  type;
 };
 
+/* parameters a demod was last started with */
+struct mci_tune {
+	u32                  valid;
+	u32                  tuner;
+	u32                  delivery_system;
+	u32                  frequency;
+	u32                  symbol_rate;
+	u32                  bandwidth_hz;
+	u32                  modulation;
+	u32                  rolloff;
+	u32                  stream_id;
+	u32                  scrambling_sequence_index;
+};
+
 struct mci {
 	struct ddb_io       *input;
 	struct mci_base     *base;
@@ -1282,6 +1296,7 @@ struct mci {
 	struct mci_command   cmd;
 	struct mci_result    result;
 	struct mci_result    signal_info;
+	struct mci_tune      tune;
 };
 
 struct mci_cfg {
@@ -1301,6 +1316,8 @@ int ddb_mci_get_snr(struct dvb_frontend *fe);
 int ddb_mci_get_info(struct mci *mci);
 int ddb_mci_get_strength(struct dvb_frontend *fe);
 void ddb_mci_proc_info(struct mci *mci, struct dtv_frontend_properties *p);
+void ddb_mci_save_tune(struct mci *mci, struct dtv_frontend_properties *p);
+int ddb_mci_same_tune(struct mci *mci, struct dtv_frontend_properties *p);
 int mci_init(struct ddb_link *link);
 
 #endif
@@ -83,6 +83,10 @@ static int ns_alloc(struct dvbnss *nss)
 			continue;
 		dev->ns[i].input = input;
 		dev->ns[i].fe = input;
+		dev->ns[i].slot = 0;
+		dev->ns[i].rtcp_len = 0;
+		dev->ns[i].rtcp_msg_len = 0;
+		dev->ns[i].ts_packets = 0;
 		nss->priv = &dev->ns[i];
 		ret = 0;
 		break;
@@ -242,15 +246,95 @@ static u8 rtcp_head[] = {
 	/* string off 102:68 */
 };
 
+/*
+ * Layout of the 512 byte packet memory of a stream:
+ *
+ *   0    RTP header template slot 0, inserted TS packets follow it
+ *   96   RTCP template and message
+ *   432  RTP header template slot 1
+ *
+ * set_net prepares the new RTP header in the slot not in use and switches
+ * with one STREAM_RTP_PACKET write, so a running stream never sends a
+ * partly written header. Slot 1 is only used while neither RTCP data nor
+ * inserted TS packets reach into it, otherwise slot 0 is updated in place.
+ * The in place update is left to commit_net, so a failed batch does not
+ * change what a running stream sends.
+ */
+#define NS_RTCP_OFF        96
+#define NS_RTP_SLOT1       432
+
+static u32 ns_rtp_off(u32 slot)
+{
+	return slot ? NS_RTP_SLOT1 : 0;
+}
+
+static void ns_rtcp_patch(struct ddb_ns *dns)
+{
+	u32 end = NS_RTCP_OFF + dns->rtcp_len;
+	u32 len = dns->rtcp_msg_len;
+	u16 wlen;
+
+	dns->p[end - 2] = (len >> 8);
+	dns->p[end - 1] = (len & 0xff);
+	if (len & 3) {
+		u32 pad = 4 - (len & 3);
+
+		memset(dns->p + end + len, 0, pad);
+		len += pad;
+	}
+	wlen = len / 4;
+	wlen += 3;
+	dns->p[end - 14] = (wlen >> 8);
+	dns->p[end - 13] = (wlen & 0xff);
+}
+
+/* RTCP is paused while its template is rewritten */
+static void ns_rtcp_upload(struct dvbnss *nss, int enable)
+{
+	struct dvb_netstream *ns = nss->ns;
+	struct ddb_input *input = ns->priv;
+	struct ddb *dev = input->port->dev;
+	struct ddb_ns *dns = (struct ddb_ns *)nss->priv;
+	u32 ctrl = ddbreadl(dev, STREAM_CONTROL(dns->nr));
+	u32 len = ALIGN(dns->rtcp_msg_len, 4);
+
+	if (ctrl & 0x10)
+		ddbwritel(dev, ctrl & ~0x10, STREAM_CONTROL(dns->nr));
+	ddbcpyto(dev, STREAM_PACKET_ADR(dns->nr) + NS_RTCP_OFF,
+		 dns->p + NS_RTCP_OFF, dns->rtcp_len + len);
+	ddbwritel(dev, (dns->rtcp_udplen + len) |
+		  ((STREAM_PACKET_OFF(dns->nr) + NS_RTCP_OFF) << 16),
+		  STREAM_RTCP_PACKET(dns->nr));
+	if (enable)
+		ctrl |= 0x10;
+	if (ctrl & 0x10)
+		ddbwritel(dev, ctrl, STREAM_CONTROL(dns->nr));
+}
+
+/* move the RTP header back to slot 0 before something else needs slot 1 */
+static void ns_rtp_to_slot0(struct dvbnss *nss)
+{
+	struct dvb_netstream *ns = nss->ns;
+	struct ddb_input *input = ns->priv;
+	struct ddb *dev = input->port->dev;
+	struct ddb_ns *dns = (struct ddb_ns *)nss->priv;
+
+	if (!dns->slot)
+		return;
+	memcpy(dns->p, dns->p + NS_RTP_SLOT1, dns->ts_offset);
+	ddbcpyto(dev, STREAM_PACKET_ADR(dns->nr), dns->p, dns->ts_offset);
+	ddbwritel(dev, dns->udplen | (STREAM_PACKET_OFF(dns->nr) << 16),
+		  STREAM_RTP_PACKET(dns->nr));
+	dns->slot = 0;
+}
+
 static int ns_set_rtcp_msg(struct dvbnss *nss, u8 *msg, u32 len)
 {
 	struct dvb_netstream *ns = nss->ns;
 	struct ddb_input *input = ns->priv;
 	struct ddb *dev = input->port->dev;
 	struct ddb_ns *dns = (struct ddb_ns *)nss->priv;
-	u32 off = STREAM_PACKET_ADR(dns->nr);
-	u32 coff = 96;
-	u16 wlen;
+	u32 end = NS_RTCP_OFF + dns->rtcp_len + ALIGN(len, 4);
 
 	if (!len) {
 		ddbwritel(dev, ddbreadl(dev, STREAM_CONTROL(dns->nr)) &
@@ -258,26 +342,15 @@ static int ns_set_rtcp_msg(struct dvbnss *nss, u8 *msg, u32 len)
 			  STREAM_CONTROL(dns->nr));
 		return 0;
 	}
-	if (copy_from_user(dns->p + coff + dns->rtcp_len, msg, len))
+	if (end > sizeof(dns->p))
+		return -EINVAL;
+	if (end > NS_RTP_SLOT1)
+		ns_rtp_to_slot0(nss);
+	if (copy_from_user(dns->p + NS_RTCP_OFF + dns->rtcp_len, msg, len))
 		return -EFAULT;
-	dns->p[coff + dns->rtcp_len - 2] = (len >> 8);
-	dns->p[coff + dns->rtcp_len - 1] = (len & 0xff);
-	if (len & 3) {
-		u32 pad = 4 - (len & 3);
-
-		memset(dns->p + coff + dns->rtcp_len + len, 0, pad);
-		len += pad;
-	}
-	wlen = len / 4;
-	wlen += 3;
-	dns->p[coff + dns->rtcp_len - 14] = (wlen >> 8);
-	dns->p[coff + dns->rtcp_len - 13] = (wlen & 0xff);
-	ddbcpyto(dev, off, dns->p, sizeof(dns->p));
-	ddbwritel(dev, (dns->rtcp_udplen + len) |
-		  ((STREAM_PACKET_OFF(dns->nr) + coff) << 16),
-		  STREAM_RTCP_PACKET(dns->nr));
-	ddbwritel(dev, ddbreadl(dev, STREAM_CONTROL(dns->nr)) | 0x10,
-		  STREAM_CONTROL(dns->nr));
+	dns->rtcp_msg_len = len;
+	ns_rtcp_patch(dns);
+	ns_rtcp_upload(nss, 1);
 	return 0;
 }
 
@@ -379,10 +452,14 @@ static int ns_set_ts_packets(struct dvbnss *nss, u8 *buf, u32 len)
 
 	if (nss->params.flags & DVB_NS_RTCP)
 		return -EINVAL;
+	if (len > 2 * 188)
+		return -EINVAL;
 
+	ns_rtp_to_slot0(nss);
 	if (copy_from_user(dns->p + dns->ts_offset, buf, len))
 		return -EFAULT;
-	ddbcpyto(dev, off, dns->p, sizeof(dns->p));
+	dns->ts_packets = len / 188;
+	ddbcpyto(dev, off + dns->ts_offset, dns->p + dns->ts_offset, len);
 	return 0;
 }
 
@@ -404,26 +481,98 @@ static int ns_insert_ts_packets(struct dvbnss *nss, u8 count)
 	return 0;
 }
 
-static int ns_set_net(struct dvbnss *nss)
+/* build the RTP header for nss->params in a free slot and upload it */
+static int ns_prepare_net(struct dvbnss *nss)
 {
 	struct dvb_netstream *ns = nss->ns;
 	struct ddb_input *input = ns->priv;
 	struct ddb *dev = input->port->dev;
 	struct dvb_ns_params *p = &nss->params;
 	struct ddb_ns *dns = (struct ddb_ns *)nss->priv;
-	u32 off = STREAM_PACKET_ADR(dns->nr);
-	u32 coff = 96;
+	u32 off, len, tlen = dns->ts_packets * 188, udplen;
+	u32 rtcp_end = NS_RTCP_OFF + dns->rtcp_len +
+		ALIGN(dns->rtcp_msg_len, 4);
+	u8 rtcp[160];
+	int slot = dns->slot ^ 1;
+
+	if (p->flags & DVB_NS_RTCP) {
+		u32 end = NS_RTCP_OFF +
+			set_nsbuf(p, rtcp, &udplen, 1, dev->vlan) +
+			ALIGN(dns->rtcp_msg_len, 4);
+
+		if (end > sizeof(dns->p))
+			return -EINVAL;
+		if (end > rtcp_end)
+			rtcp_end = end;
+		tlen = 0;
+	}
+	if (slot && (tlen || rtcp_end > NS_RTP_SLOT1))
+		slot = 0;
+	len = set_nsbuf(p, dns->next_hdr, &dns->next_udplen, 0, dev->vlan);
+	dns->next_slot = slot;
+	dns->next_ts_offset = len;
+	if (slot == dns->slot)
+		return 0;
+	off = ns_rtp_off(slot);
+	memcpy(dns->p + off, dns->next_hdr, len);
+	ddbcpyto(dev, STREAM_PACKET_ADR(dns->nr) + off, dns->p + off, len);
+	return 0;
+}
 
-	dns->ts_offset = set_nsbuf(p, dns->p, &dns->udplen, 0, dev->vlan);
-	if (nss->params.flags & DVB_NS_RTCP)
-		dns->rtcp_len = set_nsbuf(p, dns->p + coff,
-					  &dns->rtcp_udplen, 1, dev->vlan);
-	ddbcpyto(dev, off, dns->p, sizeof(dns->p));
-	ddbwritel(dev, dns->udplen | (STREAM_PACKET_OFF(dns->nr) << 16),
+/* switch to the prepared RTP header, then rebuild the RTCP template */
+static void ns_commit_net(struct dvbnss *nss)
+{
+	struct dvb_netstream *ns = nss->ns;
+	struct ddb_input *input = ns->priv;
+	struct ddb *dev = input->port->dev;
+	struct dvb_ns_params *p = &nss->params;
+	struct ddb_ns *dns = (struct ddb_ns *)nss->priv;
+	u32 len, mlen = ALIGN(dns->rtcp_msg_len, 4);
+	u32 off, tlen = dns->ts_packets * 188;
+	u8 rtcp[160];
+
+	if (dns->next_slot == dns->slot) {
+		/* no free slot, rewrite the live one */
+		off = ns_rtp_off(dns->slot);
+		len = dns->next_ts_offset;
+		if (p->flags & DVB_NS_RTCP)
+			tlen = 0;
+		if (tlen)
+			memmove(dns->p + off + len,
+				dns->p + dns->ts_offset, tlen);
+		memcpy(dns->p + off, dns->next_hdr, len);
+		ddbcpyto(dev, STREAM_PACKET_ADR(dns->nr) + off, dns->p + off,
+			 len + tlen);
+	}
+	ddbwritel(dev, dns->next_udplen |
+		  ((STREAM_PACKET_OFF(dns->nr) +
+		    ns_rtp_off(dns->next_slot)) << 16),
 		  STREAM_RTP_PACKET(dns->nr));
-	ddbwritel(dev, dns->rtcp_udplen |
-		  ((STREAM_PACKET_OFF(dns->nr) + coff) << 16),
-		  STREAM_RTCP_PACKET(dns->nr));
+	dns->slot = dns->next_slot;
+	dns->udplen = dns->next_udplen;
+	dns->ts_offset = dns->next_ts_offset;
+
+	if (!(p->flags & DVB_NS_RTCP))
+		return;
+	dns->ts_packets = 0;
+	len = set_nsbuf(p, rtcp, &dns->rtcp_udplen, 1, dev->vlan);
+	memmove(dns->p + NS_RTCP_OFF + len,
+		dns->p + NS_RTCP_OFF + dns->rtcp_len, mlen);
+	memcpy(dns->p + NS_RTCP_OFF, rtcp, len);
+	dns->rtcp_len = len;
+	if (dns->rtcp_msg_len)
+		ns_rtcp_patch(dns);
+	ns_rtcp_upload(nss, 0);
+}
+
+static int ns_set_net(struct dvbnss *nss)
+{
+	int ret;
+
+	ret = ns_prepare_net(nss);
+	if (ret < 0)
+		return ret;
+	ns_commit_net(nss);
 	return 0;
 }
 
@@ -478,6 +627,8 @@ int netstream_init(struct ddb_input *input)
 		dev->ns[i].nr = i;
 	ns->priv = input;
 	ns->set_net = ns_set_net;
+	ns->prepare_net = ns_prepare_net;
+	ns->commit_net = ns_commit_net;
 	ns->set_rtcp_msg = ns_set_rtcp_msg;
 	ns->set_ts_packets = ns_set_ts_packets;
 	ns->insert_ts_packets = ns_insert_ts_packets;
@@ -0,0 +1,472 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * ddbridge-sim.c: Digital Devices bridge simulation
+ *
+ * Copyright (C) 2010-2019 Digital Devices GmbH
+ *                         Ralph Metzler <rjkm@metzlerbros.de>
+ *                         Marcus Metzler <mocm@metzlerbros.de>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 only, as published by the Free Software Foundation.
+ *
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, point your browser to
+ * http://www.gnu.org/copyleft/gpl.html
+ */
+
+/*
+ * A software model of an Octopus bridge with four dual dummy tuner ports.
+ * Register accesses are routed here by ddbreadl()/ddbwritel() and the
+ * interrupt status, DMA_BUFFER_CONTROL/ACK/CURRENT of link 0 are emulated.
+ * A periodic hrtimer plays the DMA engine:
+ *
+ * - running input DMAs are filled at sim_rate with TS from the sim_ts
+ *   firmware file or from a generator. Generated packets use PID
+ *   0x100 + DMA number, a continuous CC and carry a big endian 64 bit
+ *   ktime_get() stamp and a 32 bit sequence number after the header.
+ *   If the consumer does not ACK in time the DMA stalls (bit 2 in
+ *   DMA_BUFFER_CONTROL) and dropped packets are counted in TS_STAT.
+ *
+ * - running output DMAs are drained at sim_rate up to the ACKed position.
+ *
+ * Each completed block raises the interrupt of its DMA and the regular
+ * ddb_irq_handler() is called from the timer.
+ */
+
+#include "ddbridge.h"
+#include "ddbridge-io.h"
+
+#include <linux/firmware.h>
+#include <linux/hrtimer.h>
+#if (KERNEL_VERSION(6, 12, 0) > LINUX_VERSION_CODE)
+#include <asm/unaligned.h>
+#else
+#include <linux/unaligned.h>
+#endif
+
+#define DDB_SIM_MAX       4
+#define DDB_SIM_REGS_SIZE 0x100000
+#define DDB_SIM_DEVICE    0x00fe
+
+static int sim_devices;
+module_param(sim_devices, int, 0444);
+MODULE_PARM_DESC(sim_devices,
+		 "number of simulated bridges to create (default 0, max 4)");
+
+static int sim_rate = 50000;
+module_param(sim_rate, int, 0644);
+MODULE_PARM_DESC(sim_rate,
+		 "TS rate of simulated DMA channels in kBit/s (default 50000)");
+
+static int sim_tick = 500;
+module_param(sim_tick, int, 0444);
+MODULE_PARM_DESC(sim_tick,
+		 "DMA engine period of simulated bridges in us (default 500)");
+
+static char *sim_ts;
+module_param(sim_ts, charp, 0444);
+MODULE_PARM_DESC(sim_ts,
+		 "firmware file with TS played in a loop on simulated inputs");
+
+struct ddb_sim_dma {
+	u32 ctrl;
+	u32 ack;
+	u32 cur;
+	u32 off;
+	u32 stalled;
+	u32 lost;
+	u64 frac;
+	u32 credit;
+	u32 fpos;
+	u32 seq;
+	u8  cc;
+};
+
+struct ddb_sim {
+	struct ddb *dev;
+	spinlock_t lock; /* emulated register state */
+	struct hrtimer timer;
+	ktime_t last;
+	u32 status;
+	u32 rate;
+	const struct firmware *fw;
+	u32 fw_len;
+	struct ddb_sim_dma idma[DDB_MAX_INPUT];
+	struct ddb_sim_dma odma[DDB_MAX_OUTPUT];
+};
+
+static struct ddb *sim_ddb[DDB_SIM_MAX];
+
+static inline u32 *sim_reg(struct ddb *dev, u32 adr)
+{
+	return (u32 *)(dev->regs + adr);
+}
+
+/* find the emulated DMA channel behind a register address */
+static struct ddb_sim_dma *sim_dma(struct ddb *dev, u32 adr, u32 *reg,
+				   int *out)
+{
+	const struct ddb_regmap *rm = dev->link[0].info->regmap;
+	struct ddb_sim *sim = dev->sim;
+	u32 nr;
+
+	if (rm->idma && adr >= rm->idma->base &&
+	    adr < rm->idma->base + rm->idma->num * rm->idma->size) {
+		nr = (adr - rm->idma->base) / rm->idma->size;
+		*reg = (adr - rm->idma->base) % rm->idma->size;
+		*out = 0;
+		return &sim->idma[nr];
+	}
+	if (rm->odma && adr >= rm->odma->base &&
+	    adr < rm->odma->base + rm->odma->num * rm->odma->size) {
+		nr = (adr - rm->odma->base) / rm->odma->size;
+		*reg = (adr - rm->odma->base) % rm->odma->size;
+		*out = 1;
+		return &sim->odma[nr];
+	}
+	return NULL;
+}
+
+u32 ddb_sim_readl(struct ddb *dev, u32 adr)
+{
+	struct ddb_sim *sim = dev->sim;
+	struct ddb_sim_dma *sd;
+	unsigned long flags;
+	u32 reg, val;
+	int out;
+
+	if (adr & 0xf0000000 || adr >= DDB_SIM_REGS_SIZE)
+		return 0;
+	spin_lock_irqsave(&sim->lock, flags);
+	if (adr == INTERRUPT_STATUS) {
+		val = sim->status;
+	} else {
+		sd = sim_dma(dev, adr, &reg, &out);
+		if (sd && reg == 0x00)
+			val = sd->ctrl;
+		else if (sd && reg == 0x08)
+			val = (sd->cur << 11) | (sd->off >> 7);
+		else
+			val = *sim_reg(dev, adr);
+	}
+	spin_unlock_irqrestore(&sim->lock, flags);
+	return val;
+}
+
+void ddb_sim_writel(struct ddb *dev, u32 val, u32 adr)
+{
+	struct ddb_sim *sim = dev->sim;
+	struct ddb_sim_dma *sd;
+	unsigned long flags;
+	u32 reg;
+	int out;
+
+	if (adr & 0xf0000000 || adr >= DDB_SIM_REGS_SIZE)
+		return;
+	spin_lock_irqsave(&sim->lock, flags);
+	if (adr == INTERRUPT_ACK) {
+		sim->status &= ~val;
+		goto out;
+	}
+	*sim_reg(dev, adr) = val;
+	sd = sim_dma(dev, adr, &reg, &out);
+	if (!sd)
+		goto out;
+	switch (reg) {
+	case 0x00:
+		if ((val & 1) && !(sd->ctrl & 1)) {
+			sd->cur = sd->off = 0;
+			sd->stalled = 0;
+			sd->frac = 0;
+			sd->credit = 0;
+		}
+		sd->ctrl = val;
+		break;
+	case 0x04:
+		if (out) {
+			sd->ack = val;
+			break;
+		}
+		sd->ack = (val >> 11) & 0x1f;
+		/* consumer made room, resume writing into the current block */
+		if (sd->stalled && sd->ack != sd->cur) {
+			sd->stalled = 0;
+			sd->ctrl &= ~4;
+		}
+		break;
+	default:
+		break;
+	}
+out:
+	spin_unlock_irqrestore(&sim->lock, flags);
+}
+
+static u32 sim_credit(struct ddb_sim_dma *sd, u64 dt, u32 rate)
+{
+	u32 rem;
+
+	sd->frac += dt * rate;
+	sd->credit += div_u64_rem(sd->frac, 8000000, &rem);
+	sd->frac = rem;
+	return sd->credit;
+}
+
+static void sim_packet(struct ddb_sim *sim, struct ddb_sim_dma *sd,
+		       u32 nr, u8 *p, u64 stamp)
+{
+	if (sim->fw) {
+		memcpy(p, sim->fw->data + sd->fpos, 188);
+		sd->fpos += 188;
+		if (sd->fpos >= sim->fw_len)
+			sd->fpos = 0;
+		return;
+	}
+	p[0] = 0x47;
+	p[1] = (0x100 + nr) >> 8;
+	p[2] = (0x100 + nr) & 0xff;
+	p[3] = 0x10 | (sd->cc++ & 0x0f);
+	put_unaligned_be64(stamp, p + 4);
+	put_unaligned_be32(sd->seq++, p + 12);
+	memset(p + 16, 0xff, 188 - 16);
+}
+
+static void sim_input(struct ddb_sim *sim, u32 nr, u64 dt, u64 stamp)
+{
+	struct ddb *dev = sim->dev;
+	struct ddb_sim_dma *sd = &sim->idma[nr];
+	struct ddb_dma *dma = &dev->idma[nr];
+	const struct ddb_regmap *rm = dev->link[0].info->regmap;
+
+	if (!dma->num || !dma->vbuf[sd->cur])
+		return;
+	sim_credit(sd, dt, sim->rate);
+	while (sd->credit >= 188) {
+		sd->credit -= 188;
+		if (sd->stalled) {
+			sd->lost++;
+			continue;
+		}
+		sim_packet(sim, sd, nr, dma->vbuf[sd->cur] + sd->off, stamp);
+		sd->off += 188;
+		if (sd->off + 188 <= dma->size)
+			continue;
+		sd->off = 0;
+		sd->cur = (sd->cur + 1) % dma->num;
+		sim->status |= 1 << (rm->irq_base_idma + nr);
+		if (sd->cur == sd->ack) {
+			sd->stalled = 1;
+			sd->ctrl |= 4;
+		}
+	}
+	if (sd->lost && dma->io)
+		*sim_reg(dev, TS_STAT((struct ddb_input *)dma->io)) =
+			sd->lost & 0xffff;
+}
+
+static void sim_output(struct ddb_sim *sim, u32 nr, u64 dt)
+{
+	struct ddb *dev = sim->dev;
+	struct ddb_sim_dma *sd = &sim->odma[nr];
+	struct ddb_dma *dma = &dev->odma[nr];
+	const struct ddb_regmap *rm = dev->link[0].info->regmap;
+	u32 total, rpos, apos, avail, len;
+
+	if (!dma->num)
+		return;
+	total = dma->num * dma->size;
+	rpos = sd->cur * dma->size + sd->off;
+	apos = ((sd->ack >> 11) & 0x1f) * dma->size + ((sd->ack & 0x7ff) << 7);
+	avail = (apos + total - rpos) % total;
+	sim_credit(sd, dt, sim->rate);
+	len = min(sd->credit, avail) & ~127;
+	if (!len) {
+		if (!avail)
+			sd->credit = 0;
+		return;
+	}
+	sd->credit -= len;
+	if ((rpos % dma->size) + len >= dma->size)
+		sim->status |= 1 << (rm->irq_base_odma + nr);
+	rpos = (rpos + len) % total;
+	sd->cur = rpos / dma->size;
+	sd->off = rpos % dma->size;
+}
+
+static enum hrtimer_restart sim_timer(struct hrtimer *timer)
+{
+	struct ddb_sim *sim = container_of(timer, struct ddb_sim, timer);
+	struct ddb *dev = sim->dev;
+	const struct ddb_regmap *rm = dev->link[0].info->regmap;
+	ktime_t now = ktime_get();
+	u64 dt = ktime_to_ns(ktime_sub(now, sim->last));
+	u32 i, s;
+
+	sim->last = now;
+	spin_lock(&sim->lock);
+	sim->rate = sim_rate;
+	for (i = 0; rm->idma && i < rm->idma->num; i++)
+		if (sim->idma[i].ctrl & 1)
+			sim_input(sim, i, dt, ktime_to_ns(now));
+	for (i = 0; rm->odma && i < rm->odma->num; i++)
+		if (sim->odma[i].ctrl & 1)
+			sim_output(sim, i, dt);
+	s = sim->status & *sim_reg(dev, INTERRUPT_ENABLE);
+	spin_unlock(&sim->lock);
+
+	if (s)
+		ddb_irq_handler(0, dev);
+	hrtimer_forward_now(timer, ns_to_ktime(sim_tick * 1000ULL));
+	return HRTIMER_RESTART;
+}
+
+static void ddb_sim_remove(struct ddb *dev)
+{
+	struct platform_device *pfdev = dev->pfdev;
+	struct ddb_sim *sim = dev->sim;
+
+	hrtimer_cancel(&sim->timer);
+	ddb_device_destroy(dev);
+	ddb_nsd_detach(dev);
+	ddb_ports_detach(dev);
+	ddb_i2c_release(dev);
+	ddb_ports_release(dev);
+	ddb_buffers_free(dev);
+
+	if (sim->fw)
+		release_firmware(sim->fw);
+	vfree(dev->regs);
+	dev->regs = NULL;
+	kfree(sim);
+	ddb_unmap(dev);
+	platform_device_unregister(pfdev);
+}
+
+static struct ddb *ddb_sim_create(int nr)
+{
+	struct platform_device_info pinfo = {
+		.name = "ddbridge-sim",
+		.id = nr,
+		.dma_mask = DMA_BIT_MASK(32),
+	};
+	struct platform_device *pfdev;
+	struct ddb_sim *sim;
+	struct ddb *dev;
+
+	pfdev = platform_device_register_full(&pinfo);
+	if (IS_ERR(pfdev))
+		return NULL;
+	dev = vzalloc(sizeof(*dev));
+	sim = kzalloc(sizeof(*sim), GFP_KERNEL);
+	if (!dev || !sim)
+		goto fail;
+	dev->regs = vzalloc(DDB_SIM_REGS_SIZE);
+	if (!dev->regs)
+		goto fail;
+	dev->regs_len = DDB_SIM_REGS_SIZE;
+
+	mutex_init(&dev->mutex);
+	spin_lock_init(&sim->lock);
+	sim->dev = dev;
+	sim->rate = sim_rate;
+	dev->sim = sim;
+	dev->has_dma = 1;
+	dev->pfdev = pfdev;
+	dev->dev = &pfdev->dev;
+	platform_set_drvdata(pfdev, dev);
+
+	dev->link[0].ids.vendor = 0xdd01;
+	dev->link[0].ids.device = DDB_SIM_DEVICE;
+	dev->link[0].ids.subvendor = 0xdd01;
+	dev->link[0].ids.subdevice = 0x0001;
+	dev->link[0].ids.devid = (DDB_SIM_DEVICE << 16) | 0xdd01;
+	dev->link[0].dev = dev;
+	dev->link[0].info = get_ddb_info(0xdd01, DDB_SIM_DEVICE,
+					 0xdd01, 0x0001);
+
+	if (sim_ts) {
+		if (request_firmware(&sim->fw, sim_ts, dev->dev) < 0) {
+			dev_warn(dev->dev, "could not load %s, using generator\n",
+				 sim_ts);
+			sim->fw = NULL;
+		} else {
+			sim->fw_len = sim->fw->size - sim->fw->size % 188;
+			if (!sim->fw_len || sim->fw->data[0] != 0x47) {
+				dev_warn(dev->dev, "%s is no aligned TS, using generator\n",
+					 sim_ts);
+				release_firmware(sim->fw);
+				sim->fw = NULL;
+			}
+		}
+	}
+	dev_info(dev->dev, "%s, %u kBit/s per DMA\n",
+		 dev->link[0].info->name, sim_rate);
+
+	ddbwritel(dev, 0, DMA_BASE_READ);
+	ddbwritel(dev, 0, DMA_BASE_WRITE);
+	ddbwritel(dev, 0xffffffff, INTERRUPT_ACK);
+	ddbwritel(dev, 0x0fffff0f, INTERRUPT_ENABLE);
+
+#if (KERNEL_VERSION(6, 13, 0) <= LINUX_VERSION_CODE)
+	hrtimer_setup(&sim->timer, sim_timer, CLOCK_MONOTONIC,
+		      HRTIMER_MODE_REL);
+#else
+	hrtimer_init(&sim->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	sim->timer.function = sim_timer;
+#endif
+	sim->last = ktime_get();
+	hrtimer_start(&sim->timer, ns_to_ktime(sim_tick * 1000ULL),
+		      HRTIMER_MODE_REL);
+
+	if (ddb_init(dev) == 0)
+		return dev;
+
+	hrtimer_cancel(&sim->timer);
+	if (sim->fw)
+		release_firmware(sim->fw);
+fail:
+	if (dev)
+		vfree(dev->regs);
+	kfree(sim);
+	vfree(dev);
+	platform_device_unregister(pfdev);
+	return NULL;
+}
+
+int ddb_sim_init(void)
+{
+	int i;
+
+	if (sim_devices > DDB_SIM_MAX)
+		sim_devices = DDB_SIM_MAX;
+	if (sim_tick < 50)
+		sim_tick = 50;
+	for (i = 0; i < sim_devices; i++) {
+		sim_ddb[i] = ddb_sim_create(i);
+		if (!sim_ddb[i]) {
+			pr_err("DDBridge: could not create simulated bridge %d\n",
+			       i);
+			break;
+		}
+	}
+	return i;
+}
+
+void ddb_sim_exit(void)
+{
+	int i;
+
+	for (i = 0; i < DDB_SIM_MAX; i++) {
+		if (!sim_ddb[i])
+			continue;
+		ddb_sim_remove(sim_ddb[i]);
+		sim_ddb[i] = NULL;
+	}
+}
@@ -41,6 +41,11 @@ static u32 sx8_tuner_gain;
 module_param(sx8_tuner_gain, int, 0664);
 MODULE_PARM_DESC(sx8_tuner_gain, "Change SX8 tuner gain.");
 
+static int sx8_reserve_wide;
+module_param(sx8_reserve_wide, int, 0664);
+MODULE_PARM_DESC(sx8_reserve_wide,
+		 "Number of full rate SX8 demods (0-4) kept free for high symbol rate carriers.");
+
 static const u32 MCLK = (1550000000 / 12);
 
 /* Add 2MBit/s overhead allowance (minimum factor is 90/32400 for QPSK w/o Pilots) */
@@ -57,6 +62,7 @@ struct sx8_base {
 	u8                   tuner_use_count[SX8_TUNER_NUM];
 
 	u32                  used_ldpc_bitrate[SX8_DEMOD_NUM];
+	u8                   ldpc_tuner[SX8_DEMOD_NUM];
 	u8                   demod_in_use[SX8_DEMOD_NUM];
 	u32                  iq_mode;
 };
@@ -205,6 +211,7 @@ static int stop_iq(struct dvb_frontend *fe)
 
 	if (!state->iq_started)
 		return -1;
+	state->mci.tune.valid = 0;
 	memset(&cmd, 0, sizeof(cmd));
 	cmd.command = SX8_CMD_STOP_IQ;
 	cmd.demod = state->mci.demod;
@@ -237,6 +244,7 @@ static int stop(struct dvb_frontend *fe)
 	input = state->mci.tuner;
 	if (!state->started)
 		return -1;
+	state->mci.tune.valid = 0;
 	if (state->mci.demod != SX8_DEMOD_NONE) {
 		memset(&cmd, 0, sizeof(cmd));
 		cmd.command = MCI_CMD_STOP;
@@ -270,6 +278,57 @@ static const u8 ro_lut[8] = {
 	8 | SX8_ROLLOFF_15, 8 | SX8_ROLLOFF_10, 8 | SX8_ROLLOFF_05, 0,
 };
 
+/*
+ * Demods 0-3 can handle symbol rates up to MCLK, 4-7 only up to MCLK/2.
+ * Narrow carriers are packed onto 4-7 first and only take a full rate
+ * demod while more than sx8_reserve_wide of them are still free.
+ */
+static int pick_demod(struct sx8_base *sx8_base, int wide)
+{
+	int i, free_wide = 0;
+
+	for (i = 0; i < 4; i++)
+		if (!sx8_base->demod_in_use[i])
+			free_wide++;
+	for (i = wide ? 3 : 7; i >= 0; i--) {
+		if (sx8_base->demod_in_use[i])
+			continue;
+		if (!wide && i < 4 && free_wide <= sx8_reserve_wide)
+			return -1;
+		return i;
+	}
+	return -1;
+}
+
+int ddb_sx8_ldpc_show(struct mci_base *mci_base, char *buf)
+{
+	struct sx8_base *sx8_base = (struct sx8_base *) mci_base;
+	u32 used = 0, free, max = 0, tused[SX8_TUNER_NUM] = { 0 };
+	int i, len, free_demods = 0, free_wide = 0;
+
+	mutex_lock(&mci_base->tuner_lock);
+	for (i = 0; i < SX8_DEMOD_NUM; i++) {
+		used += sx8_base->used_ldpc_bitrate[i];
+		if (sx8_base->used_ldpc_bitrate[i])
+			tused[sx8_base->ldpc_tuner[i]] +=
+				sx8_base->used_ldpc_bitrate[i];
+		if (!sx8_base->demod_in_use[i]) {
+			free_demods++;
+			if (i < 4)
+				free_wide++;
+		}
+	}
+	free = (used < MAX_LDPC_BITRATE) ? MAX_LDPC_BITRATE - used : 0;
+	if (free_demods && !sx8_base->iq_mode)
+		max = min(free, MAX_DEMOD_LDPC_BITRATE);
+	len = sprintf(buf, "total %u used %u free %u max %u demods %d wide %d\n",
+		      MAX_LDPC_BITRATE, used, free, max, free_demods, free_wide);
+	for (i = 0; i < SX8_TUNER_NUM; i++)
+		len += sprintf(buf + len, "tuner%d %u\n", i, tused[i]);
+	mutex_unlock(&mci_base->tuner_lock);
+	return len;
+}
+
 static int start(struct dvb_frontend *fe, u32 flags, u32 modmask, u32 ts_config)
 {
 	struct sx8 *state = fe->demodulator_priv;
@@ -346,9 +405,7 @@ static int start(struct dvb_frontend *fe, u32 flags, u32 modmask, u32 ts_config)
 			goto unlock;
 		}
 		
-		i = (p->symbol_rate > MCLK / 2) ? 3 : 7;
-		while (i >= 0 && sx8_base->demod_in_use[i])
-			i--;
+		i = pick_demod(sx8_base, p->symbol_rate > MCLK / 2);
 	}
 	if (i < 0) { 
 		stat = -EBUSY;
@@ -356,6 +413,7 @@ static int start(struct dvb_frontend *fe, u32 flags, u32 modmask, u32 ts_config)
 	}
         sx8_base->demod_in_use[i] = 1;
 	sx8_base->used_ldpc_bitrate[state->mci.nr] = p->symbol_rate * bits_per_symbol;
+	sx8_base->ldpc_tuner[state->mci.nr] = input;
         state->mci.demod = i;
 
         if (!sx8_base->tuner_use_count[input])
@@ -407,9 +465,32 @@ unlock:
 	state->mci.signal_info.status = MCI_DEMOD_WAIT_SIGNAL;
 	if (stat)
 		stop(fe);
+	else
+		ddb_mci_save_tune(&state->mci, p);
 	return stat;
 }
 
+/*
+ * Take an extra reference on the tuner input so that a restart of the
+ * demod does not switch the tuner off and on again.
+ */
+static void hold_tuner(struct dvb_frontend *fe, u32 input, int hold)
+{
+	struct sx8 *state = fe->demodulator_priv;
+	struct mci_base *mci_base = state->mci.base;
+	struct sx8_base *sx8_base = (struct sx8_base *) mci_base;
+
+	mutex_lock(&mci_base->tuner_lock);
+	if (hold) {
+		sx8_base->tuner_use_count[input]++;
+	} else {
+		sx8_base->tuner_use_count[input]--;
+		if (!sx8_base->tuner_use_count[input])
+			mci_set_tuner(fe, input, 0, 0, 0);
+	}
+	mutex_unlock(&mci_base->tuner_lock);
+}
+
 
 static int start_iq(struct dvb_frontend *fe, u32 flags,
 		    u32 ts_config)
@@ -482,16 +563,27 @@ static int set_parameters(struct dvb_frontend *fe)
 	struct sx8 *state = fe->demodulator_priv;
 	struct dtv_frontend_properties *p = &fe->dtv_property_cache;
 	u32 ts_config = SX8_TSCONFIG_MODE_NORMAL, iq_mode = 0, isi, ts_mode = 0;
+	u32 input = state->mci.tuner;
+	int held = 0;
 
 	isi = p->stream_id;
 	if (isi != NO_STREAM_ID_FILTER) {
 		iq_mode = (isi & 0x30000000) >> 28;
 		ts_mode = (isi & 0x03000000) >> 24;
 	}
+	mutex_lock(&state->lock);
+	if (state->started && !iq_mode &&
+	    ddb_mci_same_tune(&state->mci, p)) {
+		mutex_unlock(&state->lock);
+		return 0;
+	}
 	state->mci.input->con = ts_mode << 8;
 	if (iq_mode)
 		ts_config = (SX8_TSCONFIG_TSHEADER | SX8_TSCONFIG_MODE_IQ);
-	mutex_lock(&state->lock);
+	if (state->started && !iq_mode) {
+		hold_tuner(fe, input, 1);
+		held = 1;
+	}
 	stop(fe);
 	if (iq_mode < 2) {
 		u32 mask;
@@ -524,6 +616,8 @@ static int set_parameters(struct dvb_frontend *fe)
 	} else {
 		stat = start_iq(fe, isi & 0xffffff, ts_config);
 	}
+	if (held)
+		hold_tuner(fe, input, 0);
 	mutex_unlock(&state->lock);
 	return stat;
 }
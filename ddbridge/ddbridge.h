@@ -189,6 +189,15 @@ struct ddb_info {
 
 struct ddb;
 struct ddb_port;
+struct ddb_sim;
+
+struct ddb_nsd_req {
+	struct list_head       list;
+	struct file           *file;
+	struct ddb_input      *input;
+	struct dvb_nsd_ts      ts;
+	struct dvb_nsd_result  res;
+};
 
 struct ddb_dma {
 	void                  *io;
@@ -214,6 +223,17 @@ struct ddb_dma {
 	u32                    stall_count;
 	u32                    packet_loss;
 	u32                    unaligned;
+
+	/* producer rate measurement for automatic CI bitrate */
+	struct delayed_work    rate_work;
+	u32                    rate_fill;
+	u32                    rate_pos;
+	unsigned long          rate_jiffies;
+
+	/* input block completion times (ns), see input_stamp() */
+	spinlock_t             stamp_lock;
+	u64                    btime[DMA_MAX_BUFS];
+	u32                    bidx;
 };
 
 struct ddb_dvb {
@@ -234,6 +254,7 @@ struct ddb_dvb {
 
 	enum fe_sec_tone_mode  tone;
 	enum fe_sec_voltage    voltage;
+	struct mci            *mci; /* MCI demod, see max_sec_changed() */
 
 	int (*i2c_gate_ctrl)(struct dvb_frontend *fe, int val);
 	int (*set_voltage)(struct dvb_frontend *fe,
@@ -331,7 +352,8 @@ struct ddb_port {
 	struct dvb_ca_en50221 *en;
 	struct ddb_dvb         dvb[2];
 	u32                    gap;
-	u32                    obr;
+	u32                    obr;  /* 0 = automatic, use aobr */
+	u32                    aobr;
 	u8                     creg;
 };
 
@@ -386,6 +408,10 @@ struct ddb_mod {
 #define CM_ADJUST  2
 
 #define TS_CAPTURE_LEN  (4096)
+#define DDB_NSD_USERS   32
+/* NSD_QUEUE_GET_TS requests queued, running or not yet read */
+#define DDB_NSD_REQS       64
+#define DDB_NSD_FILE_REQS  16
 
 /* net streaming hardware block */
 
@@ -397,8 +423,18 @@ struct ddb_ns {
 	struct ddb_input      *fe;
 	u32                    rtcp_udplen;
 	u32                    rtcp_len;
+	u32                    rtcp_msg_len;
 	u32                    ts_offset;
+	u32                    ts_packets;
 	u32                    udplen;
+
+	/* RTP header template in use and the one prepared by set_net */
+	u32                    slot;
+	u32                    next_slot;
+	u32                    next_udplen;
+	u32                    next_ts_offset;
+	u8                     next_hdr[96]; /* in place update of the live slot */
+
 	u8                     p[512];
 };
 
@@ -437,15 +473,32 @@ struct ddb_link {
 	int                    mci_ok;
 };
 
+#define DDB_MAX_MSI 8
+
+/* interrupt status bits which can be routed to MSI vectors */
+#define DDB_IRQ_VEC_MSG  0x0000000f
+#define DDB_IRQ_VEC_IO   0x0fffff00
+
+struct ddb_msi_vec {
+	struct ddb            *dev;
+	u32                    nr;
+	u32                    mask;
+};
+
 struct ddb {
 	struct pci_dev        *pdev;
 	struct platform_device *pfdev;
 	struct device         *dev;
 
 	int                    msi;
+	struct ddb_msi_vec     msi_vec[DDB_MAX_MSI];
+	u8                     irq_vec[32];
 	struct workqueue_struct *wq;
 	u32                    has_dma;
 	u32                    has_ns;
+#ifdef CONFIG_DVB_DDBRIDGE_SIM
+	struct ddb_sim        *sim;
+#endif
 
 	struct ddb_link        link[DDB_MAX_LINK];
 	unsigned char         *regs;
@@ -477,6 +530,18 @@ struct ddb {
 	struct dvb_device     *nsd_dev;
 	u8                     tsbuf[TS_CAPTURE_LEN];
 
+	/* queued TS captures, see NSD_QUEUE_GET_TS */
+	struct mutex           nsd_lock;
+	struct list_head       nsd_queue;
+	spinlock_t             nsd_dlock; /* protects nsd_done */
+	struct list_head       nsd_done;
+	struct ddb_nsd_req    *nsd_cur;
+	struct file           *nsd_single; /* owner of NSD_START_GET_TS */
+	unsigned long          nsd_start;
+	u32                    nsd_id;
+	struct delayed_work    nsd_work;
+	wait_queue_head_t      nsd_wq;
+
 	struct mod_base        mod_base;
 	struct ddb_mod         mod[24];
 	struct mutex           ioctl_mutex; /* lock extra ioctls */
@@ -562,6 +627,8 @@ irqreturn_t ddb_irq_handler0(int irq, void *dev_id);
 irqreturn_t ddb_irq_handler1(int irq, void *dev_id);
 irqreturn_t ddb_irq_handler(int irq, void *dev_id);
 irqreturn_t ddb_irq_handler_v2(int irq, void *dev_id);
+irqreturn_t ddb_irq_handler_vec(int irq, void *dev_id);
+void ddb_irq_vec_update(struct ddb *dev);
 void ddb_reset_ios(struct ddb *dev);
 int ddb_init(struct ddb *dev);
 int ddb_exit_ddbridge(int stage, int error);
@@ -582,8 +649,21 @@ struct ddb_irq *ddb_irq_set(struct ddb *dev, u32 link, u32 nr,
 struct dvb_frontend *ddb_mci_attach(struct ddb_input *input, struct mci_cfg *cfg, int nr, int tuner, u8 flags);
 struct dvb_frontend *ddb_sx8_attach(struct ddb_input *input, int nr, int tuner,
 				    int (**fn_set_input)(struct dvb_frontend *fe, int input));
+int ddb_sx8_ldpc_show(struct mci_base *mci_base, char *buf);
 struct dvb_frontend *ddb_mx_attach(struct ddb_input *input, int nr, int tuner, int type);
 
+#ifdef CONFIG_DVB_DDBRIDGE_SIM
+int ddb_sim_init(void);
+void ddb_sim_exit(void);
+u32 ddb_sim_readl(struct ddb *dev, u32 adr);
+void ddb_sim_writel(struct ddb *dev, u32 val, u32 adr);
+#define ddb_is_sim(_dev) unlikely((_dev)->sim != NULL)
+#else
+static inline int ddb_sim_init(void) { return 0; }
+static inline void ddb_sim_exit(void) { }
+#define ddb_is_sim(_dev) 0
+#endif
+
 int ddb_dvb_usercopy(struct file *file, unsigned int cmd, unsigned long arg,
 		     int (*func)(struct file *file, unsigned int cmd, void *arg));
 #endif
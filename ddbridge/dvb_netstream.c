@@ -24,6 +24,7 @@
  */
 
 #include <linux/net.h>
+#include <linux/file.h>
 #include "dvb_netstream.h"
 
 int ddb_dvb_usercopy(struct file *file, unsigned int cmd, unsigned long arg,
@@ -104,6 +105,110 @@ static int set_net(struct dvbnss *nss, struct dvb_ns_params *p)
 	return 0;
 }
 
+static const struct file_operations ns_fops;
+
+/* serializes batches, each of them holds the mutexes of several devices */
+static DEFINE_MUTEX(ns_batch_lock);
+
+/* lock or unlock the mutex of every netstream device in the batch once */
+static void ns_batch_lock_all(struct file **files, u32 n, int lock)
+{
+	struct dvb_netstream *ns;
+	u32 i, j;
+
+	for (i = 0; i < n; i++) {
+		ns = ((struct dvbnss *)files[i]->private_data)->ns;
+		for (j = 0; j < i; j++)
+			if (((struct dvbnss *)files[j]->private_data)->ns == ns)
+				break;
+		if (j < i)
+			continue;
+		if (lock)
+			mutex_lock_nest_lock(&ns->mutex, &ns_batch_lock);
+		else
+			mutex_unlock(&ns->mutex);
+	}
+}
+
+/*
+ * Prepare the new headers of all streams first and then switch them in
+ * one pass, so many streams change their destination at nearly the same
+ * time. Nothing is switched if one of them fails.
+ */
+static int ns_set_net_batch(struct dvb_ns_net_batch *b)
+{
+	struct dvb_ns_net *net;
+	struct file **files;
+	struct dvbnss *nss;
+	struct dvb_ns_params tmp;
+	u32 i, j, n = b->num;
+	int ret = 0;
+
+	if (!n || n > DVB_NS_BATCH_MAX)
+		return -EINVAL;
+	net = kmalloc_array(n, sizeof(*net), GFP_KERNEL);
+	files = kcalloc(n, sizeof(*files), GFP_KERNEL);
+	if (!net || !files) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	if (copy_from_user(net, b->net, n * sizeof(*net))) {
+		ret = -EFAULT;
+		goto out;
+	}
+	for (i = 0; i < n; i++) {
+		files[i] = fget(net[i].fd);
+		if (!files[i] || files[i]->f_op != &ns_fops) {
+			ret = -EBADF;
+			goto out;
+		}
+		nss = files[i]->private_data;
+		if (!nss->ns->prepare_net || !nss->ns->commit_net) {
+			ret = -EOPNOTSUPP;
+			goto out;
+		}
+		/* the rollback below needs each stream only once */
+		for (j = 0; j < i; j++)
+			if (files[j]->private_data == nss) {
+				ret = -EINVAL;
+				goto out;
+			}
+	}
+	mutex_lock(&ns_batch_lock);
+	ns_batch_lock_all(files, n, 1);
+	for (i = 0; i < n; i++) {
+		nss = files[i]->private_data;
+		/* keep the old parameters in net[] until all are prepared */
+		memcpy(&tmp, &nss->params, sizeof(tmp));
+		memcpy(&nss->params, &net[i].params, sizeof(tmp));
+		memcpy(&net[i].params, &tmp, sizeof(tmp));
+		ret = nss->ns->prepare_net(nss);
+		if (ret < 0) {
+			for (j = i + 1; j-- > 0;) {
+				nss = files[j]->private_data;
+				memcpy(&nss->params, &net[j].params,
+				       sizeof(tmp));
+			}
+			goto unlock;
+		}
+	}
+	for (i = 0; i < n; i++) {
+		nss = files[i]->private_data;
+		nss->ns->commit_net(nss);
+	}
+unlock:
+	ns_batch_lock_all(files, n, 0);
+	mutex_unlock(&ns_batch_lock);
+out:
+	if (files)
+		for (i = 0; i < n; i++)
+			if (files[i])
+				fput(files[i]);
+	kfree(files);
+	kfree(net);
+	return ret;
+}
+
 static int do_ioctl(struct file *file, unsigned int cmd, void *parg)
 {
 	struct dvbnss *nss = file->private_data;
@@ -116,17 +221,25 @@ static int do_ioctl(struct file *file, unsigned int cmd, void *parg)
 	{
 		struct dvb_ns_rtcp *rtcpm = parg;
 
+		mutex_lock(&ns->mutex);
 		if (ns->set_rtcp_msg)
 			ret = ns->set_rtcp_msg(nss, rtcpm->msg, rtcpm->len);
+		mutex_unlock(&ns->mutex);
 		break;
 	}
 
 	case NS_SET_NET:
+		mutex_lock(&ns->mutex);
 		memcpy(&nss->params, parg, sizeof(nss->params));
 		if (ns->set_net)
 			ret = ns->set_net(nss);
 		else
 			ret = set_net(nss, (struct dvb_ns_params *) parg);
+		mutex_unlock(&ns->mutex);
+		break;
+
+	case NS_SET_NET_BATCH:
+		ret = ns_set_net_batch(parg);
 		break;
 
 	case NS_START:
@@ -148,9 +261,11 @@ static int do_ioctl(struct file *file, unsigned int cmd, void *parg)
 	{
 		struct dvb_ns_packet *packet =  parg;
 
+		mutex_lock(&ns->mutex);
 		if (ns->set_ts_packets)
 			ret = ns->set_ts_packets(nss, packet->buf,
 						 packet->count * 188);
+		mutex_unlock(&ns->mutex);
 		break;
 	}
 
@@ -73,6 +73,11 @@ struct dvb_netstream {
 	struct list_head nssl;
 
 	int (*set_net)(struct dvbnss *);
+	/* set_net in two steps for NS_SET_NET_BATCH: prepare_net must not
+	 * change what a running stream sends, commit_net switches over
+	 */
+	int (*prepare_net)(struct dvbnss *);
+	void (*commit_net)(struct dvbnss *);
 	int (*set_pid)(struct dvbnss *, u16);
 	int (*set_pids)(struct dvbnss *);
 	int (*set_ci)(struct dvbnss *, u8);
@@ -415,12 +415,73 @@ static void dvb_dmxdev_filter_timer(struct dmxdev_filter *dmxdevfilter)
 }
 #endif
 
+static u8 dvb_dmxdev_sec_byte(const u8 *buffer1, size_t buffer1_len,
+			       const u8 *buffer2, size_t off)
+{
+	if (off < buffer1_len)
+		return buffer1[off];
+	return buffer2[off - buffer1_len];
+}
+
+/*
+ * Looks up the cache entry of this section and fills key with its
+ * identity. Returns 1 if an identical copy was already delivered, the
+ * caller stores key in *slot once the section is in the buffer. The
+ * cache is direct mapped, so a collision can only cause a repeated
+ * delivery, never a lost change.
+ */
+static int dvb_dmxdev_section_seen(struct dmxdev_filter *dmxdevfilter,
+				   const u8 *buffer1, size_t buffer1_len,
+				   const u8 *buffer2, size_t buffer2_len,
+				   struct dmxdev_sec_cache *key,
+				   struct dmxdev_sec_cache **slot)
+{
+	struct dmxdev_sec_cache *c;
+	size_t len = buffer1_len + buffer2_len;
+	u32 crc = 0;
+	int i;
+
+	*slot = NULL;
+	/* short sections have no version and no CRC */
+	if (buffer1_len < 8 || len < 12 || !(buffer1[1] & 0x80))
+		return 0;
+
+	key->table_id = buffer1[0];
+	key->ext = (buffer1[3] << 8) | buffer1[4];
+	key->version = (buffer1[5] >> 1) & 0x1f;
+	key->secnum = buffer1[6];
+	for (i = 4; i > 0; i--)
+		crc = (crc << 8) | dvb_dmxdev_sec_byte(buffer1, buffer1_len,
+						       buffer2, len - i);
+	key->crc = crc;
+	key->valid = 1;
+
+	c = &dmxdevfilter->sec_cache[(key->table_id ^ key->ext ^
+				      (key->ext >> 8) ^
+				      (key->secnum * 31)) &
+				     (DMXDEV_SEC_CACHE_SIZE - 1)];
+	*slot = c;
+	return c->valid && c->table_id == key->table_id &&
+		c->ext == key->ext && c->secnum == key->secnum &&
+		c->version == key->version && c->crc == key->crc;
+}
+
+/* sections lost with a flushed buffer must be delivered again */
+static void dvb_dmxdev_sec_cache_reset(struct dmxdev_filter *dmxdevfilter)
+{
+	if (dmxdevfilter->sec_cache)
+		memset(dmxdevfilter->sec_cache, 0,
+		       DMXDEV_SEC_CACHE_SIZE *
+		       sizeof(struct dmxdev_sec_cache));
+}
+
 static int dvb_dmxdev_section_callback(const u8 *buffer1, size_t buffer1_len,
 				       const u8 *buffer2, size_t buffer2_len,
 				       struct dmx_section_filter *filter,
 				       u32 *buffer_flags)
 {
 	struct dmxdev_filter *dmxdevfilter = filter->priv;
+	struct dmxdev_sec_cache key, *slot = NULL;
 	int ret;
 
 #ifdef CONFIG_DVB_MMAP
@@ -437,6 +498,13 @@ static int dvb_dmxdev_section_callback(const u8 *buffer1, size_t buffer1_len,
 		spin_unlock(&dmxdevfilter->dev->lock);
 		return 0;
 	}
+	if ((dmxdevfilter->params.sec.flags & DMX_CHANGED_ONLY) &&
+	    dmxdevfilter->sec_cache &&
+	    dvb_dmxdev_section_seen(dmxdevfilter, buffer1, buffer1_len,
+				    buffer2, buffer2_len, &key, &slot)) {
+		spin_unlock(&dmxdevfilter->dev->lock);
+		return 0;
+	}
 #if (LINUX_VERSION_CODE >= KERNEL_VERSION(6, 15, 0))
 	timer_delete(&dmxdevfilter->timer);
 #else
@@ -468,8 +536,12 @@ static int dvb_dmxdev_section_callback(const u8 *buffer1, size_t buffer1_len,
 					      buffer2_len);
 	}
 #endif
-	if (ret < 0)
+	if (ret < 0) {
 		dmxdevfilter->buffer.error = ret;
+		dvb_dmxdev_sec_cache_reset(dmxdevfilter);
+	} else if (slot) {
+		*slot = key;
+	}
 	if (dmxdevfilter->params.sec.flags & DMX_ONESHOT)
 		dmxdevfilter->state = DMXDEV_STATE_DONE;
 	spin_unlock(&dmxdevfilter->dev->lock);
@@ -477,6 +549,41 @@ static int dvb_dmxdev_section_callback(const u8 *buffer1, size_t buffer1_len,
 	return 0;
 }
 
+/*
+ * Build a timestamp record if the filter asked for it and the demux is
+ * fed from a new hardware block. The last block time is tracked per
+ * output buffer, so several filters writing to the dvr device produce
+ * one record per block.
+ */
+static int dvb_dmxdev_ts_record(struct dmxdev_filter *dmxdevfilter,
+				struct dmx_ts_record *rec)
+{
+	struct dmxdev *dmxdev = dmxdevfilter->dev;
+	u64 t = dmxdev->demux->block_time;
+	u64 *last;
+
+	if (!(dmxdevfilter->params.pes.flags & DMX_TIMESTAMPS) ||
+	    dmxdevfilter->params.pes.output == DMX_OUT_TAP || !t)
+		return 0;
+	if (dmxdevfilter->params.pes.output == DMX_OUT_TS_TAP)
+		last = &dmxdev->dvr_block_time;
+	else
+		last = &dmxdevfilter->block_time;
+	if (t == *last)
+		return 0;
+	*last = t;
+
+	memset(rec, 0xff, sizeof(*rec));
+	rec->header[0] = 0x47;
+	rec->header[1] = 0x1f;
+	rec->header[2] = 0xff;
+	rec->header[3] = 0x10;
+	memcpy(rec->magic, "DDBT", 4);
+	rec->block_time = cpu_to_be64(t);
+	rec->demux_time = cpu_to_be64(ktime_to_ns(ktime_get()));
+	return sizeof(*rec);
+}
+
 static int dvb_dmxdev_ts_callback(const u8 *buffer1, size_t buffer1_len,
 				  const u8 *buffer2, size_t buffer2_len,
 				  struct dmx_ts_feed *feed,
@@ -487,7 +594,8 @@ static int dvb_dmxdev_ts_callback(const u8 *buffer1, size_t buffer1_len,
 #ifdef CONFIG_DVB_MMAP
 	struct dvb_vb2_ctx *ctx;
 #endif
-	int ret;
+	struct dmx_ts_record rec;
+	int ret, reclen;
 
 	spin_lock(&dmxdevfilter->dev->lock);
 	if (dmxdevfilter->params.pes.output == DMX_OUT_DECODER) {
@@ -507,9 +615,12 @@ static int dvb_dmxdev_ts_callback(const u8 *buffer1, size_t buffer1_len,
 		ctx = &dmxdevfilter->dev->dvr_vb2_ctx;
 #endif
 	}
+	reclen = dvb_dmxdev_ts_record(dmxdevfilter, &rec);
 
 #ifdef CONFIG_DVB_MMAP
 	if (dvb_vb2_is_streaming(ctx)) {
+		if (reclen)
+			dvb_vb2_fill_buffer(ctx, (u8 *)&rec, reclen, NULL);
 		ret = dvb_vb2_fill_buffer(ctx, buffer1, buffer1_len,
 					  buffer_flags);
 		if (ret == buffer1_len)
@@ -522,6 +633,8 @@ static int dvb_dmxdev_ts_callback(const u8 *buffer1, size_t buffer1_len,
 			wake_up(&buffer->queue);
 			return 0;
 		}
+		if (reclen)
+			dvb_dmxdev_buffer_write(buffer, (u8 *)&rec, reclen);
 		ret = dvb_dmxdev_buffer_write(buffer, buffer1, buffer1_len);
 		if (ret == buffer1_len)
 			ret = dvb_dmxdev_buffer_write(buffer,
@@ -761,6 +874,7 @@ static int dvb_dmxdev_filter_start(struct dmxdev_filter *filter)
 		*secfilter = NULL;
 		*secfeed = NULL;
 
+		dvb_dmxdev_sec_cache_reset(filter);
 
 		/* find active filter/feed with same PID */
 		for (i = 0; i < dmxdev->filternum; i++) {
@@ -923,6 +1037,14 @@ static int dvb_dmxdev_filter_free(struct dmxdev *dmxdev,
 		spin_unlock_irq(&dmxdev->lock);
 		vfree(mem);
 	}
+	if (dmxdevfilter->sec_cache) {
+		void *cache = dmxdevfilter->sec_cache;
+
+		spin_lock_irq(&dmxdev->lock);
+		dmxdevfilter->sec_cache = NULL;
+		spin_unlock_irq(&dmxdev->lock);
+		kfree(cache);
+	}
 
 	dvb_dmxdev_filter_state_set(dmxdevfilter, DMXDEV_STATE_FREE);
 	wake_up(&dmxdevfilter->buffer.queue);
@@ -997,6 +1119,14 @@ static int dvb_dmxdev_filter_set(struct dmxdev *dmxdev,
 
 	dvb_dmxdev_filter_stop(dmxdevfilter);
 
+	if ((params->flags & DMX_CHANGED_ONLY) && !dmxdevfilter->sec_cache) {
+		dmxdevfilter->sec_cache =
+			kcalloc(DMXDEV_SEC_CACHE_SIZE,
+				sizeof(struct dmxdev_sec_cache), GFP_KERNEL);
+		if (!dmxdevfilter->sec_cache)
+			return -ENOMEM;
+	}
+
 	dmxdevfilter->type = DMXDEV_TYPE_SEC;
 	memcpy(&dmxdevfilter->params.sec,
 	       params, sizeof(struct dmx_sct_filter_params));
@@ -1039,6 +1169,17 @@ static int dvb_dmxdev_pes_filter_set(struct dmxdev *dmxdev,
 	return 0;
 }
 
+/* the buffer was flushed if the read returned its error */
+static void dvb_dmxdev_read_sec_error(struct dmxdev_filter *dfil, int result)
+{
+	if (result == -EWOULDBLOCK || result == -ERESTARTSYS ||
+	    result == -EFAULT)
+		return;
+	spin_lock_irq(&dfil->dev->lock);
+	dvb_dmxdev_sec_cache_reset(dfil);
+	spin_unlock_irq(&dfil->dev->lock);
+}
+
 static ssize_t dvb_dmxdev_read_sec(struct dmxdev_filter *dfil,
 				   struct file *file, char __user *buf,
 				   size_t count, loff_t *ppos)
@@ -1054,6 +1195,7 @@ static ssize_t dvb_dmxdev_read_sec(struct dmxdev_filter *dfil,
 						file->f_flags & O_NONBLOCK,
 						buf, hcount, ppos);
 		if (result < 0) {
+			dvb_dmxdev_read_sec_error(dfil, result);
 			dfil->todo = 0;
 			return result;
 		}
@@ -1074,8 +1216,10 @@ static ssize_t dvb_dmxdev_read_sec(struct dmxdev_filter *dfil,
 	result = dvb_dmxdev_buffer_read(&dfil->buffer,
 					file->f_flags & O_NONBLOCK,
 					buf, count, ppos);
-	if (result < 0)
+	if (result < 0) {
+		dvb_dmxdev_read_sec_error(dfil, result);
 		return result;
+	}
 	dfil->todo -= result;
 	return (result + done);
 }
@@ -1518,6 +1662,7 @@ int dvb_dmxdev_init(struct dmxdev *dmxdev, struct dvb_adapter *dvb_adapter)
 	for (i = 0; i < dmxdev->filternum; i++) {
 		dmxdev->filter[i].dev = dmxdev;
 		dmxdev->filter[i].buffer.data = NULL;
+		dmxdev->filter[i].sec_cache = NULL;
 		dvb_dmxdev_filter_state_set(&dmxdev->filter[i],
 					    DMXDEV_STATE_FREE);
 	}
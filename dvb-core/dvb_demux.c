@@ -504,6 +504,15 @@ static void dvb_dmx_swfilter_packet(struct dvb_demux *demux, const u8 *buf)
 	}
 }
 
+/* called without the demux lock, consumers may raise softirqs here */
+static void dvb_dmx_block_done(struct dvb_demux *demux)
+{
+	void (*done)(void *priv) = demux->dmx.block_done;
+
+	if (done)
+		done(demux->dmx.block_done_priv);
+}
+
 void dvb_dmx_swfilter_packets(struct dvb_demux *demux, const u8 *buf,
 			      size_t count)
 {
@@ -518,6 +527,7 @@ void dvb_dmx_swfilter_packets(struct dvb_demux *demux, const u8 *buf,
 	}
 
 	spin_unlock_irqrestore(&demux->lock, flags);
+	dvb_dmx_block_done(demux);
 }
 
 EXPORT_SYMBOL(dvb_dmx_swfilter_packets);
@@ -599,6 +609,7 @@ static inline void _dvb_dmx_swfilter(struct dvb_demux *demux, const u8 *buf,
 
 bailout:
 	spin_unlock_irqrestore(&demux->lock, flags);
+	dvb_dmx_block_done(demux);
 }
 
 void dvb_dmx_swfilter(struct dvb_demux *demux, const u8 *buf, size_t count)
@@ -631,6 +642,7 @@ void dvb_dmx_swfilter_raw(struct dvb_demux *demux, const u8 *buf, size_t count)
 #endif	
 
 	spin_unlock_irqrestore(&demux->lock, flags);
+	dvb_dmx_block_done(demux);
 }
 EXPORT_SYMBOL(dvb_dmx_swfilter_raw);
 
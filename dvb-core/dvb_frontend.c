@@ -47,6 +47,7 @@ static int dvb_force_auto_inversion;
 static int dvb_override_tune_delay;
 static int dvb_powerdown_on_sleep = 1;
 static int dvb_mfe_wait_time = 5;
+static int dvb_stats_interval = 1000;
 
 module_param_named(frontend_debug, dvb_frontend_debug, int, 0644);
 MODULE_PARM_DESC(frontend_debug, "Turn on/off frontend core debugging (default:off).");
@@ -60,6 +61,8 @@ module_param(dvb_powerdown_on_sleep, int, 0644);
 MODULE_PARM_DESC(dvb_powerdown_on_sleep, "0: do not power down, 1: turn LNB voltage off on sleep (default)");
 module_param(dvb_mfe_wait_time, int, 0644);
 MODULE_PARM_DESC(dvb_mfe_wait_time, "Wait up to <mfe_wait_time> seconds on open() for multi-frontend to become available (default:5 seconds)");
+module_param(dvb_stats_interval, int, 0644);
+MODULE_PARM_DESC(dvb_stats_interval, "Interval in milliseconds at which the statistics of frontends with update_stats are sampled (default:1000, 0: on every status poll)");
 
 #define dprintk(fmt, arg...) \
 	printk(KERN_DEBUG pr_fmt("%s: " fmt), __func__, ##arg)
@@ -112,6 +115,8 @@ struct dvb_frontend_private {
 	unsigned int reinitialise;
 	int tone;
 	int voltage;
+	unsigned long tune_jiffies;
+	unsigned long stats_jiffies;
 
 	/* swzigzag values */
 	unsigned int state;
@@ -370,6 +375,16 @@ void dvb_frontend_reinitialise(struct dvb_frontend *fe)
 }
 EXPORT_SYMBOL(dvb_frontend_reinitialise);
 
+enum fe_status dvb_frontend_cached_status(struct dvb_frontend *fe)
+{
+	struct dvb_frontend_private *fepriv = fe->frontend_priv;
+
+	if (!fepriv || !fepriv->thread || fepriv->state == FESTATE_IDLE)
+		return 0;
+	return fepriv->status;
+}
+EXPORT_SYMBOL(dvb_frontend_cached_status);
+
 static void dvb_frontend_swzigzag_update_delay(struct dvb_frontend_private *fepriv, int locked)
 {
 	int q2;
@@ -669,6 +684,42 @@ static void dvb_frontend_wakeup(struct dvb_frontend *fe)
 	wake_up_interruptible(&fepriv->wait_queue);
 }
 
+static void dvb_frontend_update_stats(struct dvb_frontend *fe)
+{
+	struct dvb_frontend_private *fepriv = fe->frontend_priv;
+
+	if (!fe->ops.update_stats)
+		return;
+	if (dvb_stats_interval > 0 &&
+	    time_before(jiffies, fepriv->stats_jiffies))
+		return;
+	fepriv->stats_jiffies = jiffies + msecs_to_jiffies(dvb_stats_interval);
+	if (fepriv->state != FESTATE_IDLE)
+		fe->ops.update_stats(fe);
+}
+
+/* Sleep until the next tuning loop iteration or the next statistics
+ * sample, whichever comes first.
+ */
+static long dvb_frontend_timeout(struct dvb_frontend *fe)
+{
+	struct dvb_frontend_private *fepriv = fe->frontend_priv;
+	long timeout = (long)(fepriv->tune_jiffies - jiffies);
+
+	if (timeout < 1)
+		timeout = 1;
+	if (fe->ops.update_stats && dvb_stats_interval > 0 &&
+	    fepriv->state != FESTATE_IDLE) {
+		long stats = (long)(fepriv->stats_jiffies - jiffies);
+
+		if (stats < 1)
+			stats = 1;
+		if (stats < timeout)
+			timeout = stats;
+	}
+	return timeout;
+}
+
 static int dvb_frontend_thread(void *data)
 {
 	struct dvb_frontend *fe = data;
@@ -678,6 +729,7 @@ static int dvb_frontend_thread(void *data)
 	enum dvbfe_algo algo;
 	bool re_tune = false;
 	bool semheld = false;
+	long ret;
 
 	dev_dbg(fe->dvb->device, "%s:\n", __func__);
 
@@ -687,6 +739,8 @@ static int dvb_frontend_thread(void *data)
 	fepriv->status = 0;
 	fepriv->wakeup = 0;
 	fepriv->reinitialise = 0;
+	fepriv->stats_jiffies = jiffies;
+	fepriv->tune_jiffies = jiffies + fepriv->delay;
 
 	dvb_frontend_init(fe);
 
@@ -694,11 +748,11 @@ static int dvb_frontend_thread(void *data)
 	while (1) {
 		up(&fepriv->sem);	    /* is locked when we enter the thread... */
 restart:
-		wait_event_interruptible_timeout(fepriv->wait_queue,
+		ret = wait_event_interruptible_timeout(fepriv->wait_queue,
 						 dvb_frontend_should_wakeup(fe) ||
 						 kthread_should_stop() ||
 						 freezing(current),
-			fepriv->delay);
+			dvb_frontend_timeout(fe));
 
 		if (kthread_should_stop() || dvb_frontend_is_exiting(fe)) {
 			/* got signal or quitting */
@@ -723,6 +777,12 @@ restart:
 			fepriv->reinitialise = 0;
 		}
 
+		/* only woken up to sample the statistics */
+		if (!ret && time_before(jiffies, fepriv->tune_jiffies)) {
+			dvb_frontend_update_stats(fe);
+			continue;
+		}
+
 		/* do an iteration of the tuning loop */
 		if (fe->ops.get_frontend_algo) {
 			algo = fe->ops.get_frontend_algo(fe);
@@ -796,6 +856,8 @@ restart:
 		} else {
 			dvb_frontend_swzigzag(fe);
 		}
+		fepriv->tune_jiffies = jiffies + fepriv->delay;
+		dvb_frontend_update_stats(fe);
 	}
 
 	if (dvb_powerdown_on_sleep) {
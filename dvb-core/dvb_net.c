@@ -124,8 +124,90 @@ struct dvb_net_priv {
 	int ule_sndu_remain;			/* Nr. of bytes still required for current ULE SNDU. */
 	unsigned long ts_count;			/* Current ts cell counter. */
 	struct mutex mutex;
+	struct sk_buff_head rx_queue;		/* Decoded packets waiting for NAPI poll. */
+	struct napi_struct napi;
 };
 
+#define DVB_NET_RX_QUEUE_MAX	1024
+#define DVB_NET_NAPI_WEIGHT	64
+
+/*
+ * Received packets are queued and handed to the stack in batches from
+ * NAPI context, so the demux callback only pays for the decoding and
+ * GRO can merge consecutive segments of one flow.
+ */
+static void dvb_net_rx(struct net_device *dev, struct sk_buff *skb)
+{
+	struct dvb_net_priv *priv = netdev_priv(dev);
+
+	if (skb_queue_len(&priv->rx_queue) >= DVB_NET_RX_QUEUE_MAX) {
+		dev->stats.rx_dropped++;
+		dev_kfree_skb_any(skb);
+		return;
+	}
+	dev->stats.rx_packets++;
+	dev->stats.rx_bytes += skb->len;
+	skb_queue_tail(&priv->rx_queue, skb);
+}
+
+static void dvb_net_rx_kick(struct net_device *dev)
+{
+	struct dvb_net_priv *priv = netdev_priv(dev);
+
+	if (!skb_queue_empty(&priv->rx_queue))
+		napi_schedule(&priv->napi);
+}
+
+/*
+ * Called by the demux once per block. In process context (drivers that
+ * feed the demux from a workqueue) bottom halves are disabled around the
+ * kick, so NAPI runs on local_bh_enable() instead of waiting for the
+ * next interrupt.
+ */
+static void dvb_net_block_done(void *p)
+{
+	struct dvb_net *dvbnet = p;
+	struct net_device *net;
+	int bh = !in_interrupt();
+	int i;
+
+	if (bh)
+		local_bh_disable();
+	rcu_read_lock();
+	for (i = 0; i < DVB_NET_DEVICES_MAX; i++) {
+		net = dvbnet->device[i];
+		if (net)
+			dvb_net_rx_kick(net);
+	}
+	rcu_read_unlock();
+	if (bh)
+		local_bh_enable();
+}
+
+static int dvb_net_poll(struct napi_struct *napi, int budget)
+{
+	struct dvb_net_priv *priv = container_of(napi, struct dvb_net_priv,
+						 napi);
+	struct sk_buff *skb;
+	int done = 0;
+
+	while (done < budget && (skb = skb_dequeue(&priv->rx_queue))) {
+		napi_gro_receive(napi, skb);
+		done++;
+	}
+	if (done < budget) {
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(3, 19, 0))
+		napi_complete_done(napi, done);
+#else
+		napi_complete(napi);
+#endif
+		/* catch packets queued while we were completing */
+		if (!skb_queue_empty(&priv->rx_queue))
+			napi_schedule(napi);
+	}
+	return done;
+}
+
 
 /*
  *	Determine the packet's protocol ID. The rule here is that we
@@ -587,8 +669,8 @@ static int dvb_net_ule_new_payload(struct dvb_net_ule_handle *h)
 	 * prepare for the largest case: bridged SNDU with MAC address
 	 * (dbit = 0).
 	 */
-	h->priv->ule_skb = dev_alloc_skb(h->priv->ule_sndu_len +
-					 ETH_HLEN + ETH_ALEN);
+	h->priv->ule_skb = netdev_alloc_skb(h->dev, h->priv->ule_sndu_len +
+					    ETH_HLEN + ETH_ALEN);
 	if (!h->priv->ule_skb) {
 		pr_notice("%s: Memory squeeze, dropping packet.\n",
 			  h->dev->name);
@@ -598,7 +680,6 @@ static int dvb_net_ule_new_payload(struct dvb_net_ule_handle *h)
 
 	/* This includes the CRC32 _and_ dest mac, if !dbit. */
 	h->priv->ule_sndu_remain = h->priv->ule_sndu_len;
-	h->priv->ule_skb->dev = h->dev;
 	/*
 	 * Leave space for Ethernet or bridged SNDU header
 	 * (eth hdr plus one MAC addr).
@@ -760,9 +841,7 @@ static void dvb_net_ule_check_crc(struct dvb_net_ule_handle *h,
 	if (h->priv->ule_dbit && skb->pkt_type == PACKET_OTHERHOST)
 		h->priv->ule_skb->pkt_type = PACKET_HOST;
 #endif
-	h->dev->stats.rx_packets++;
-	h->dev->stats.rx_bytes += h->priv->ule_skb->len;
-	netif_rx(h->priv->ule_skb);
+	dvb_net_rx(h->dev, h->priv->ule_skb);
 }
 
 static void dvb_net_ule(struct net_device *dev, const u8 *buf, size_t buf_len)
@@ -949,13 +1028,12 @@ static void dvb_net_sec(struct net_device *dev,
 	/* we have 14 byte ethernet header (ip header follows);
 	 * 12 byte MPE header; 4 byte checksum; + 2 byte alignment, 8 byte LLC/SNAP
 	 */
-	if (!(skb = dev_alloc_skb(pkt_len - 4 - 12 + 14 + 2 - snap))) {
+	if (!(skb = netdev_alloc_skb(dev, pkt_len - 4 - 12 + 14 + 2 - snap))) {
 		//pr_notice("%s: Memory squeeze, dropping packet.\n", dev->name);
 		stats->rx_dropped++;
 		return;
 	}
 	skb_reserve(skb, 2);    /* longword align L3 header */
-	skb->dev = dev;
 
 	/* copy L3 payload */
 	eth = skb_put(skb, pkt_len - 12 - 4 + 14 - snap);
@@ -989,9 +1067,7 @@ static void dvb_net_sec(struct net_device *dev,
 
 	skb->protocol = dvb_net_eth_type_trans(skb, dev);
 
-	stats->rx_packets++;
-	stats->rx_bytes+=skb->len;
-	netif_rx(skb);
+	dvb_net_rx(dev, skb);
 }
 
 static int dvb_net_sec_callback(const u8 *buffer1, size_t buffer1_len,
@@ -1408,14 +1484,23 @@ static int dvb_net_add_if(struct dvb_net *dvbnet, u16 pid, u8 feedtype)
 	INIT_WORK(&priv->set_multicast_list_wq, wq_set_multicast_list);
 	INIT_WORK(&priv->restart_net_feed_wq, wq_restart_net_feed);
 	mutex_init(&priv->mutex);
+	skb_queue_head_init(&priv->rx_queue);
+#if (LINUX_VERSION_CODE >= KERNEL_VERSION(5, 19, 0))
+	netif_napi_add_weight(net, &priv->napi, dvb_net_poll,
+			      DVB_NET_NAPI_WEIGHT);
+#else
+	netif_napi_add(net, &priv->napi, dvb_net_poll, DVB_NET_NAPI_WEIGHT);
+#endif
 
 	net->base_addr = pid;
 
 	if ((result = register_netdev(net)) < 0) {
 		dvbnet->device[if_num] = NULL;
+		netif_napi_del(&priv->napi);
 		free_netdev(net);
 		return result;
 	}
+	napi_enable(&priv->napi);
 	pr_info("created network interface %s\n", net->name);
 
 	return if_num;
@@ -1435,10 +1520,15 @@ static int dvb_net_remove_if(struct dvb_net *dvbnet, unsigned long num)
 	dvb_net_stop(net);
 	flush_work(&priv->set_multicast_list_wq);
 	flush_work(&priv->restart_net_feed_wq);
+	napi_disable(&priv->napi);
+	skb_queue_purge(&priv->rx_queue);
+	netif_napi_del(&priv->napi);
 	pr_info("removed network interface %s\n", net->name);
 	unregister_netdev(net);
 	dvbnet->state[num]=0;
 	dvbnet->device[num] = NULL;
+	/* dvb_net_block_done() may still look at it */
+	synchronize_rcu();
 	free_netdev(net);
 
 	return 0;
@@ -1656,6 +1746,7 @@ void dvb_net_release (struct dvb_net *dvbnet)
 	mutex_lock(&dvbnet->remove_mutex);
 	dvbnet->exit = 1;
 	mutex_unlock(&dvbnet->remove_mutex);
+	dvbnet->demux->block_done = NULL;
 
 	if (dvbnet->dvbdev->users < 1)
 		wait_event(dvbnet->dvbdev->wait_queue,
@@ -1683,6 +1774,8 @@ int dvb_net_init (struct dvb_adapter *adap, struct dvb_net *dvbnet,
 
 	for (i=0; i<DVB_NET_DEVICES_MAX; i++)
 		dvbnet->state[i] = 0;
+	dmx->block_done_priv = dvbnet;
+	dmx->block_done = dvb_net_block_done;
 
 	return dvb_register_device(adap, &dvbnet->dvbdev, &dvbdev_net,
 			     dvbnet, DVB_DEVICE_NET, 0);
@@ -1700,8 +1700,9 @@ static int read_status(struct dvb_frontend *fe, enum fe_status *status)
 	struct cxd_state *state = fe->demodulator_priv;
 	u8 rdata;
 
+#ifdef KERNEL_DVB_CORE
 	get_stats(fe);
-
+#endif
 	*status = 0;
 	switch (state->state) {
 	case ActiveC:
@@ -2524,6 +2525,9 @@ static struct dvb_frontend_ops common_ops_2854 = {
 
 	.get_tune_settings = get_tune_settings,
 	.read_status = read_status,
+#ifndef KERNEL_DVB_CORE
+	.update_stats = get_stats,
+#endif
 	.read_ber = read_ber,
 	.read_signal_strength = read_signal_strength,
 	.read_snr = read_snr,
@@ -2558,6 +2562,9 @@ static struct dvb_frontend_ops common_ops_2843 = {
 
 	.get_tune_settings = get_tune_settings,
 	.read_status = read_status,
+#ifndef KERNEL_DVB_CORE
+	.update_stats = get_stats,
+#endif
 	.read_ber = read_ber,
 	.read_signal_strength = read_signal_strength,
 	.read_snr = read_snr,
@@ -2597,6 +2604,9 @@ static struct dvb_frontend_ops common_ops_2837 = {
 
 	.get_tune_settings = get_tune_settings,
 	.read_status = read_status,
+#ifndef KERNEL_DVB_CORE
+	.update_stats = get_stats,
+#endif
 	.read_ber = read_ber,
 	.read_signal_strength = read_signal_strength,
 	.read_snr = read_snr,
@@ -2633,6 +2643,9 @@ static struct dvb_frontend_ops common_ops_2838 = {
 
 	.get_tune_settings = get_tune_settings,
 	.read_status = read_status,
+#ifndef KERNEL_DVB_CORE
+	.update_stats = get_stats,
+#endif
 	.read_ber = read_ber,
 	.read_signal_strength = read_signal_strength,
 	.read_snr = read_snr,
@@ -34,6 +34,7 @@
 #include <media/dvb_frontend.h>
 #include "drxk.h"
 #include "drxk_hard.h"
+#include "regseq.h"
 
 static int PowerDownDVBT(struct drxk_state *state, bool setPowerMode);
 static int PowerDownQAM(struct drxk_state *state);
@@ -478,6 +479,18 @@ static int WriteBlock(struct drxk_state *state, u32 Address,
 	return  status;
 }
 
+static int WriteBlockSeq(void *priv, u32 reg, const u8 *data, int len)
+{
+	return WriteBlock(priv, reg, len, data, 0);
+}
+
+/* Table entries are in address order so that runs go out as one block */
+static int WriteTable16(struct drxk_state *state,
+			const struct regseq16 *tab, int n)
+{
+	return regseq16_write(state, tab, n, REGSEQ_MAX_BURST, WriteBlockSeq);
+}
+
 #ifndef DRXK_MAX_RETRIES_POWERUP
 #define DRXK_MAX_RETRIES_POWERUP 20
 #endif
@@ -3654,284 +3667,257 @@ static int SetQAMMeasurement(struct drxk_state *state,
 	return status;
 }
 
-static int SetQAM16 (struct drxk_state *state)
-{
-    //KdPrintEx((MSG_TRACE " - " __FUNCTION__ "\n"));
-    int status = 0;
-    do
-    {
-       /* QAM Equalizer Setup */
-       /* Equalizer */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD0__A,  13517));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD1__A,  13517));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD2__A,  13517));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD3__A,  13517));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD4__A,  13517));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD5__A,  13517));
-       /* Decision Feedback Equalizer */
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN0__A,  2));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN1__A,  2));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN2__A,  2));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN3__A,  2));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN4__A,  2));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN5__A,  0));
-
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_HWM__A, 5));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_AWM__A, 4));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_LWM__A, 3));
-
-       /* QAM Slicer Settings */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_SL_SIG_POWER__A, DRXK_QAM_SL_SIG_POWER_QAM16));
-
-       /* QAM Loop Controller Coeficients */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_FINE__A,     15));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_COARSE__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_MEDIUM__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_COARSE__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_COARSE__A,   16));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_MEDIUM__A,   20));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_COARSE__A,   80));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_MEDIUM__A,   20));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_COARSE__A,   50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_FINE__A,     16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_COARSE__A,   32));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_FINE__A,     5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_MEDIUM__A,  10));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_COARSE__A,  10));
-
-
-       /* QAM State Machine (FSM) Thresholds */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RTH__A,       140));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FTH__A,        50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_CTH__A,        95));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_PTH__A,       120));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_QTH__A,       230));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MTH__A,       105));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RATE_LIM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_COUNT_LIM__A,   4));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FREQ_LIM__A,   24));
-
-
-       /* QAM FSM Tracking Parameters */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16)  16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 220));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16)  25));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16)   6));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -65));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16)-127));
-   }while(0);
+static const struct regseq16 qam16_setup[] = {
+	{ SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16) 16 },
+	{ SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 220 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16) 25 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16) 6 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -24 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -65 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -127 },
+	{ SCU_RAM_QAM_FSM_RTH__A,             140 },
+	{ SCU_RAM_QAM_FSM_FTH__A,             50 },
+	{ SCU_RAM_QAM_FSM_PTH__A,             120 },
+	{ SCU_RAM_QAM_FSM_MTH__A,             105 },
+	{ SCU_RAM_QAM_FSM_CTH__A,             95 },
+	{ SCU_RAM_QAM_FSM_QTH__A,             230 },
+	{ SCU_RAM_QAM_FSM_RATE_LIM__A,        40 },
+	{ SCU_RAM_QAM_FSM_FREQ_LIM__A,        24 },
+	{ SCU_RAM_QAM_FSM_COUNT_LIM__A,       4 },
+	{ SCU_RAM_QAM_LC_CA_COARSE__A,        40 },
+	{ SCU_RAM_QAM_LC_CA_FINE__A,          15 },
+	{ SCU_RAM_QAM_LC_CP_COARSE__A,        80 },
+	{ SCU_RAM_QAM_LC_CP_MEDIUM__A,        20 },
+	{ SCU_RAM_QAM_LC_CP_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_CI_COARSE__A,        50 },
+	{ SCU_RAM_QAM_LC_CI_MEDIUM__A,        20 },
+	{ SCU_RAM_QAM_LC_CI_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_EP_COARSE__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_MEDIUM__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_EI_COARSE__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_CF_COARSE__A,        32 },
+	{ SCU_RAM_QAM_LC_CF_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_CF_FINE__A,          16 },
+	{ SCU_RAM_QAM_LC_CF1_COARSE__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_MEDIUM__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_FINE__A,         5 },
+	{ SCU_RAM_QAM_SL_SIG_POWER__A,        DRXK_QAM_SL_SIG_POWER_QAM16 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD0__A,         13517 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD1__A,         13517 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD2__A,         13517 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD3__A,         13517 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD4__A,         13517 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD5__A,         13517 },
+	{ QAM_DQ_QUAL_FUN0__A,                2 },
+	{ QAM_DQ_QUAL_FUN1__A,                2 },
+	{ QAM_DQ_QUAL_FUN2__A,                2 },
+	{ QAM_DQ_QUAL_FUN3__A,                2 },
+	{ QAM_DQ_QUAL_FUN4__A,                2 },
+	{ QAM_DQ_QUAL_FUN5__A,                0 },
+	{ QAM_SY_SYNC_LWM__A,                 3 },
+	{ QAM_SY_SYNC_AWM__A,                 4 },
+	{ QAM_SY_SYNC_HWM__A,                 5 },
+};
 
-    if (status<0)
-    {
-	//KdPrintEx((MSG_ERROR " - " __FUNCTION__ " status - %08x\n",status));
-    }
-    return status;
+static int SetQAM16(struct drxk_state *state)
+{
+	return WriteTable16(state, qam16_setup, ARRAY_SIZE(qam16_setup));
 }
 
 /*============================================================================*/
 
+static const struct regseq16 qam32_setup[] = {
+	{ SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16) 12 },
+	{ SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 140 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16) -8 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16) -16 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -26 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -56 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -86 },
+	{ SCU_RAM_QAM_FSM_RTH__A,             90 },
+	{ SCU_RAM_QAM_FSM_FTH__A,             50 },
+	{ SCU_RAM_QAM_FSM_PTH__A,             100 },
+	{ SCU_RAM_QAM_FSM_MTH__A,             100 },
+	{ SCU_RAM_QAM_FSM_CTH__A,             80 },
+	{ SCU_RAM_QAM_FSM_QTH__A,             170 },
+	{ SCU_RAM_QAM_FSM_RATE_LIM__A,        40 },
+	{ SCU_RAM_QAM_FSM_FREQ_LIM__A,        10 },
+	{ SCU_RAM_QAM_FSM_COUNT_LIM__A,       4 },
+	{ SCU_RAM_QAM_LC_CA_COARSE__A,        40 },
+	{ SCU_RAM_QAM_LC_CA_FINE__A,          15 },
+	{ SCU_RAM_QAM_LC_CP_COARSE__A,        80 },
+	{ SCU_RAM_QAM_LC_CP_MEDIUM__A,        20 },
+	{ SCU_RAM_QAM_LC_CP_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_CI_COARSE__A,        50 },
+	{ SCU_RAM_QAM_LC_CI_MEDIUM__A,        20 },
+	{ SCU_RAM_QAM_LC_CI_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_EP_COARSE__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_MEDIUM__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_EI_COARSE__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_CF_COARSE__A,        16 },
+	{ SCU_RAM_QAM_LC_CF_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_CF_FINE__A,          16 },
+	{ SCU_RAM_QAM_LC_CF1_COARSE__A,       0 },
+	{ SCU_RAM_QAM_LC_CF1_MEDIUM__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_FINE__A,         5 },
+	{ SCU_RAM_QAM_SL_SIG_POWER__A,        DRXK_QAM_SL_SIG_POWER_QAM32 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD0__A,         6707 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD1__A,         6707 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD2__A,         6707 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD3__A,         6707 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD4__A,         6707 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD5__A,         6707 },
+	{ QAM_DQ_QUAL_FUN0__A,                3 },
+	{ QAM_DQ_QUAL_FUN1__A,                3 },
+	{ QAM_DQ_QUAL_FUN2__A,                3 },
+	{ QAM_DQ_QUAL_FUN3__A,                3 },
+	{ QAM_DQ_QUAL_FUN4__A,                3 },
+	{ QAM_DQ_QUAL_FUN5__A,                0 },
+	{ QAM_SY_SYNC_LWM__A,                 3 },
+	{ QAM_SY_SYNC_AWM__A,                 5 },
+	{ QAM_SY_SYNC_HWM__A,                 6 },
+};
+
 /**
 * \brief QAM32 specific setup
 * \param demod instance of demod.
 * \return DRXStatus_t.
 */
-static int SetQAM32 (struct drxk_state *state)
+static int SetQAM32(struct drxk_state *state)
 {
-    //KdPrintEx((MSG_TRACE " - " __FUNCTION__ "\n"));
-    int status = 0;
-    do
-    {
-       /* QAM Equalizer Setup */
-       /* Equalizer */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD0__A,  6707));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD1__A,  6707));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD2__A,  6707));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD3__A,  6707));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD4__A,  6707));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD5__A,  6707));
-
-       /* Decision Feedback Equalizer */
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN0__A,  3));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN1__A,  3));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN2__A,  3));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN3__A,  3));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN4__A,  3));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN5__A,  0));
-
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_HWM__A, 6));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_AWM__A, 5));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_LWM__A, 3));
-
-       /* QAM Slicer Settings */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_SL_SIG_POWER__A, DRXK_QAM_SL_SIG_POWER_QAM32));
-
-
-       /* QAM Loop Controller Coeficients */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_FINE__A,     15));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_COARSE__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_MEDIUM__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_COARSE__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_COARSE__A,   16));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_MEDIUM__A,   20));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_COARSE__A,   80));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_MEDIUM__A,   20));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_COARSE__A,   50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_FINE__A,     16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_COARSE__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_FINE__A,     5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_MEDIUM__A,  10));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_COARSE__A,   0));
-
-
-       /* QAM State Machine (FSM) Thresholds */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RTH__A,        90));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FTH__A,        50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_CTH__A,        80));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_PTH__A,       100));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_QTH__A,       170));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MTH__A,       100));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RATE_LIM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_COUNT_LIM__A,   4));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FREQ_LIM__A,   10));
-
-
-       /* QAM FSM Tracking Parameters */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16)  12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 140));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16)  -8));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16) -16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -26));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -56));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -86));
-   }while(0);
-
-    if (status<0)
-    {
-	//KdPrintEx((MSG_ERROR " - " __FUNCTION__ " status - %08x\n",status));
-    }
-    return status;
+	return WriteTable16(state, qam32_setup, ARRAY_SIZE(qam32_setup));
 }
 
 /*============================================================================*/
 
+static const struct regseq16 qam64_setup[] = {
+	{ SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16) 12 },
+	{ SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 141 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16) 7 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16) 0 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -15 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -45 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -80 },
+	{ SCU_RAM_QAM_FSM_RTH__A,             100 },
+	{ SCU_RAM_QAM_FSM_FTH__A,             60 },
+	{ SCU_RAM_QAM_FSM_PTH__A,             110 },
+	{ SCU_RAM_QAM_FSM_MTH__A,             95 },
+	{ SCU_RAM_QAM_FSM_CTH__A,             80 },
+	{ SCU_RAM_QAM_FSM_QTH__A,             200 },
+	{ SCU_RAM_QAM_FSM_RATE_LIM__A,        40 },
+	{ SCU_RAM_QAM_FSM_FREQ_LIM__A,        15 },
+	{ SCU_RAM_QAM_FSM_COUNT_LIM__A,       4 },
+	{ SCU_RAM_QAM_LC_CA_COARSE__A,        40 },
+	{ SCU_RAM_QAM_LC_CA_FINE__A,          15 },
+	{ SCU_RAM_QAM_LC_CP_COARSE__A,        100 },
+	{ SCU_RAM_QAM_LC_CP_MEDIUM__A,        30 },
+	{ SCU_RAM_QAM_LC_CP_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_CI_COARSE__A,        50 },
+	{ SCU_RAM_QAM_LC_CI_MEDIUM__A,        30 },
+	{ SCU_RAM_QAM_LC_CI_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_EP_COARSE__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_MEDIUM__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_EI_COARSE__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_CF_COARSE__A,        48 },
+	{ SCU_RAM_QAM_LC_CF_MEDIUM__A,        25 },
+	{ SCU_RAM_QAM_LC_CF_FINE__A,          16 },
+	{ SCU_RAM_QAM_LC_CF1_COARSE__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_MEDIUM__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_FINE__A,         5 },
+	{ SCU_RAM_QAM_SL_SIG_POWER__A,        DRXK_QAM_SL_SIG_POWER_QAM64 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD0__A,         13336 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD1__A,         12618 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD2__A,         11988 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD3__A,         13809 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD4__A,         13809 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD5__A,         15609 },
+	{ QAM_DQ_QUAL_FUN0__A,                4 },
+	{ QAM_DQ_QUAL_FUN1__A,                4 },
+	{ QAM_DQ_QUAL_FUN2__A,                4 },
+	{ QAM_DQ_QUAL_FUN3__A,                4 },
+	{ QAM_DQ_QUAL_FUN4__A,                3 },
+	{ QAM_DQ_QUAL_FUN5__A,                0 },
+	{ QAM_SY_SYNC_LWM__A,                 3 },
+	{ QAM_SY_SYNC_AWM__A,                 4 },
+	{ QAM_SY_SYNC_HWM__A,                 5 },
+};
+
 /**
 * \brief QAM64 specific setup
 * \param demod instance of demod.
 * \return DRXStatus_t.
 */
-static int SetQAM64 (struct drxk_state *state)
+static int SetQAM64(struct drxk_state *state)
 {
-    //KdPrintEx((MSG_TRACE " - " __FUNCTION__ "\n"));
-    int status = 0;
-    do
-    {
-       /* QAM Equalizer Setup */
-       /* Equalizer */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD0__A,  13336));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD1__A,  12618));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD2__A,  11988));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD3__A,  13809));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD4__A,  13809));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD5__A,  15609));
-
-       /* Decision Feedback Equalizer */
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN0__A,  4));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN1__A,  4));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN2__A,  4));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN3__A,  4));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN4__A,  3));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN5__A,  0));
-
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_HWM__A, 5));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_AWM__A, 4));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_LWM__A, 3));
-
-       /* QAM Slicer Settings */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_SL_SIG_POWER__A, DRXK_QAM_SL_SIG_POWER_QAM64));
-
-
-       /* QAM Loop Controller Coeficients */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_FINE__A,     15));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_COARSE__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_MEDIUM__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_COARSE__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_COARSE__A,   16));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_MEDIUM__A,   30));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_COARSE__A,  100));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_MEDIUM__A,   30));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_COARSE__A,   50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_FINE__A,     16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_MEDIUM__A,   25));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_COARSE__A,   48));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_FINE__A,     5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_MEDIUM__A,  10));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_COARSE__A,  10));
-
-
-       /* QAM State Machine (FSM) Thresholds */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RTH__A,       100));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FTH__A,        60));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_CTH__A,        80));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_PTH__A,       110));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_QTH__A,       200));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MTH__A,        95));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RATE_LIM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_COUNT_LIM__A,   4));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FREQ_LIM__A,   15));
-
-
-       /* QAM FSM Tracking Parameters */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16)  12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 141));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16)   7));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16)   0));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -15));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -45));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -80));
-   }while(0);
-
-    if (status<0)
-    {
-	//KdPrintEx((MSG_ERROR " - " __FUNCTION__ " status - %08x\n",status));
-    }
-    return status;
+	return WriteTable16(state, qam64_setup, ARRAY_SIZE(qam64_setup));
 }
 
 /*============================================================================*/
 
+static const struct regseq16 qam128_setup[] = {
+	{ SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16) 8 },
+	{ SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 65 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16) 5 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16) 3 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) -1 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -12 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -23 },
+	{ SCU_RAM_QAM_FSM_RTH__A,             50 },
+	{ SCU_RAM_QAM_FSM_FTH__A,             60 },
+	{ SCU_RAM_QAM_FSM_PTH__A,             100 },
+	{ SCU_RAM_QAM_FSM_MTH__A,             100 },
+	{ SCU_RAM_QAM_FSM_CTH__A,             80 },
+	{ SCU_RAM_QAM_FSM_QTH__A,             140 },
+	{ SCU_RAM_QAM_FSM_RATE_LIM__A,        40 },
+	{ SCU_RAM_QAM_FSM_FREQ_LIM__A,        12 },
+	{ SCU_RAM_QAM_FSM_COUNT_LIM__A,       5 },
+	{ SCU_RAM_QAM_LC_CA_COARSE__A,        40 },
+	{ SCU_RAM_QAM_LC_CA_FINE__A,          15 },
+	{ SCU_RAM_QAM_LC_CP_COARSE__A,        120 },
+	{ SCU_RAM_QAM_LC_CP_MEDIUM__A,        40 },
+	{ SCU_RAM_QAM_LC_CP_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_CI_COARSE__A,        60 },
+	{ SCU_RAM_QAM_LC_CI_MEDIUM__A,        40 },
+	{ SCU_RAM_QAM_LC_CI_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_EP_COARSE__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_MEDIUM__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_EI_COARSE__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_CF_COARSE__A,        64 },
+	{ SCU_RAM_QAM_LC_CF_MEDIUM__A,        25 },
+	{ SCU_RAM_QAM_LC_CF_FINE__A,          16 },
+	{ SCU_RAM_QAM_LC_CF1_COARSE__A,       0 },
+	{ SCU_RAM_QAM_LC_CF1_MEDIUM__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_FINE__A,         5 },
+	{ SCU_RAM_QAM_SL_SIG_POWER__A,        DRXK_QAM_SL_SIG_POWER_QAM128 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD0__A,         6564 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD1__A,         6598 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD2__A,         6394 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD3__A,         6409 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD4__A,         6656 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD5__A,         7238 },
+	{ QAM_DQ_QUAL_FUN0__A,                6 },
+	{ QAM_DQ_QUAL_FUN1__A,                6 },
+	{ QAM_DQ_QUAL_FUN2__A,                6 },
+	{ QAM_DQ_QUAL_FUN3__A,                6 },
+	{ QAM_DQ_QUAL_FUN4__A,                5 },
+	{ QAM_DQ_QUAL_FUN5__A,                0 },
+	{ QAM_SY_SYNC_LWM__A,                 3 },
+	{ QAM_SY_SYNC_AWM__A,                 5 },
+	{ QAM_SY_SYNC_HWM__A,                 6 },
+};
+
 /**
 * \brief QAM128 specific setup
 * \param demod: instance of demod.
@@ -3939,96 +3925,66 @@ static int SetQAM64 (struct drxk_state *state)
 */
 static int SetQAM128(struct drxk_state *state)
 {
-    //KdPrintEx((MSG_TRACE " - " __FUNCTION__ "\n"));
-    int status = 0;
-    do
-    {
-       /* QAM Equalizer Setup */
-       /* Equalizer */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD0__A,  6564));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD1__A,  6598));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD2__A,  6394));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD3__A,  6409));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD4__A,  6656));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD5__A,  7238));
-
-       /* Decision Feedback Equalizer */
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN0__A,  6));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN1__A,  6));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN2__A,  6));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN3__A,  6));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN4__A,  5));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN5__A,  0));
-
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_HWM__A, 6));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_AWM__A, 5));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_LWM__A, 3));
-
-
-       /* QAM Slicer Settings */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_SL_SIG_POWER__A,DRXK_QAM_SL_SIG_POWER_QAM128));
-
-
-       /* QAM Loop Controller Coeficients */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_FINE__A,     15));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_COARSE__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_MEDIUM__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_COARSE__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_COARSE__A,   16));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_MEDIUM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_COARSE__A,  120));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_MEDIUM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_COARSE__A,   60));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_FINE__A,     16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_MEDIUM__A,   25));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_COARSE__A,   64));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_FINE__A,     5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_MEDIUM__A,  10));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_COARSE__A,   0));
-
-
-       /* QAM State Machine (FSM) Thresholds */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RTH__A,        50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FTH__A,        60));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_CTH__A,        80));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_PTH__A,       100));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_QTH__A,       140));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MTH__A,       100));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RATE_LIM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_COUNT_LIM__A,   5));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FREQ_LIM__A,    12));
-
-       /* QAM FSM Tracking Parameters */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16)   8));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16)  65));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16)   5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16)   3));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16)  -1));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) -12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -23));
-   }while(0);
-
-    if (status<0)
-    {
-	//KdPrintEx((MSG_ERROR " - " __FUNCTION__ " status - %08x\n",status));
-    }
-    return status;
+	return WriteTable16(state, qam128_setup, ARRAY_SIZE(qam128_setup));
 }
 
 /*============================================================================*/
 
+static const struct regseq16 qam256_setup[] = {
+	{ SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16) 8 },
+	{ SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16) 74 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16) 18 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16) 13 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16) 7 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16) 0 },
+	{ SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16) -8 },
+	{ SCU_RAM_QAM_FSM_RTH__A,             50 },
+	{ SCU_RAM_QAM_FSM_FTH__A,             60 },
+	{ SCU_RAM_QAM_FSM_PTH__A,             100 },
+	{ SCU_RAM_QAM_FSM_MTH__A,             110 },
+	{ SCU_RAM_QAM_FSM_CTH__A,             80 },
+	{ SCU_RAM_QAM_FSM_QTH__A,             150 },
+	{ SCU_RAM_QAM_FSM_RATE_LIM__A,        40 },
+	{ SCU_RAM_QAM_FSM_FREQ_LIM__A,        12 },
+	{ SCU_RAM_QAM_FSM_COUNT_LIM__A,       4 },
+	{ SCU_RAM_QAM_LC_CA_COARSE__A,        40 },
+	{ SCU_RAM_QAM_LC_CA_FINE__A,          15 },
+	{ SCU_RAM_QAM_LC_CP_COARSE__A,        250 },
+	{ SCU_RAM_QAM_LC_CP_MEDIUM__A,        50 },
+	{ SCU_RAM_QAM_LC_CP_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_CI_COARSE__A,        125 },
+	{ SCU_RAM_QAM_LC_CI_MEDIUM__A,        50 },
+	{ SCU_RAM_QAM_LC_CI_FINE__A,          5 },
+	{ SCU_RAM_QAM_LC_EP_COARSE__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_MEDIUM__A,        24 },
+	{ SCU_RAM_QAM_LC_EP_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_EI_COARSE__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_MEDIUM__A,        16 },
+	{ SCU_RAM_QAM_LC_EI_FINE__A,          12 },
+	{ SCU_RAM_QAM_LC_CF_COARSE__A,        48 },
+	{ SCU_RAM_QAM_LC_CF_MEDIUM__A,        25 },
+	{ SCU_RAM_QAM_LC_CF_FINE__A,          16 },
+	{ SCU_RAM_QAM_LC_CF1_COARSE__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_MEDIUM__A,       10 },
+	{ SCU_RAM_QAM_LC_CF1_FINE__A,         5 },
+	{ SCU_RAM_QAM_SL_SIG_POWER__A,        DRXK_QAM_SL_SIG_POWER_QAM256 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD0__A,         11502 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD1__A,         12084 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD2__A,         12543 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD3__A,         12931 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD4__A,         13629 },
+	{ SCU_RAM_QAM_EQ_CMA_RAD5__A,         15385 },
+	{ QAM_DQ_QUAL_FUN0__A,                8 },
+	{ QAM_DQ_QUAL_FUN1__A,                8 },
+	{ QAM_DQ_QUAL_FUN2__A,                8 },
+	{ QAM_DQ_QUAL_FUN3__A,                8 },
+	{ QAM_DQ_QUAL_FUN4__A,                6 },
+	{ QAM_DQ_QUAL_FUN5__A,                0 },
+	{ QAM_SY_SYNC_LWM__A,                 3 },
+	{ QAM_SY_SYNC_AWM__A,                 4 },
+	{ QAM_SY_SYNC_HWM__A,                 5 },
+};
+
 /**
 * \brief QAM256 specific setup
 * \param demod: instance of demod.
@@ -4036,91 +3992,7 @@ static int SetQAM128(struct drxk_state *state)
 */
 static int SetQAM256(struct drxk_state *state)
 {
-    //KdPrintEx((MSG_TRACE " - " __FUNCTION__ "\n"));
-    int status = 0;
-    do
-    {
-       /* QAM Equalizer Setup */
-       /* Equalizer */
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD0__A,  11502));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD1__A,  12084));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD2__A,  12543));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD3__A,  12931));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD4__A,  13629));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_EQ_CMA_RAD5__A,  15385));
-
-       /* Decision Feedback Equalizer */
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN0__A,  8));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN1__A,  8));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN2__A,  8));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN3__A,  8));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN4__A, 6));
-       CHK_ERROR(Write16_0(state, QAM_DQ_QUAL_FUN5__A, 0));
-
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_HWM__A, 5));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_AWM__A, 4));
-       CHK_ERROR(Write16_0(state, QAM_SY_SYNC_LWM__A, 3));
-
-       /* QAM Slicer Settings */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_SL_SIG_POWER__A,DRXK_QAM_SL_SIG_POWER_QAM256));
-
-
-       /* QAM Loop Controller Coeficients */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_FINE__A,     15));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CA_COARSE__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_MEDIUM__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EP_COARSE__A,   24));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_FINE__A,     12));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_MEDIUM__A,   16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_EI_COARSE__A,   16));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_MEDIUM__A,   50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CP_COARSE__A,  250));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_FINE__A,      5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_MEDIUM__A,   50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CI_COARSE__A,  125));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_FINE__A,     16));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_MEDIUM__A,   25));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF_COARSE__A,   48));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_FINE__A,     5));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_MEDIUM__A,  10));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_LC_CF1_COARSE__A,  10));
-
-
-       /* QAM State Machine (FSM) Thresholds */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RTH__A,        50));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FTH__A,        60));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_CTH__A,        80));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_PTH__A,       100));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_QTH__A,       150));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MTH__A,       110));
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RATE_LIM__A,   40));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_COUNT_LIM__A,   4));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_FREQ_LIM__A,   12));
-
-
-       /* QAM FSM Tracking Parameters */
-
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_MEDIAN_AV_MULT__A,  (u16)   8));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_RADIUS_AV_LIMIT__A, (u16)  74));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET1__A,   (u16)  18));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET2__A,   (u16)  13));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET3__A,   (u16)   7));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET4__A,   (u16)   0));
-       CHK_ERROR(Write16_0(state, SCU_RAM_QAM_FSM_LCAVG_OFFSET5__A,   (u16)  -8));
-   }while(0);
-
-    if (status<0)
-    {
-	//KdPrintEx((MSG_ERROR " - " __FUNCTION__ " status - %08x\n",status));
-    }
-    return status;
+	return WriteTable16(state, qam256_setup, ARRAY_SIZE(qam256_setup));
 }
 
 
@@ -0,0 +1,77 @@
+#ifndef _REGSEQ_H_
+#define _REGSEQ_H_
+
+#include <linux/types.h>
+
+/*
+ * Register tables written as bursts.
+ *
+ * Entries with consecutive addresses are collected into one buffer and
+ * handed to the driver's burst write function, so a table costs one
+ * I2C transfer per run instead of one per register. Table order is kept,
+ * runs are only formed from neighbouring entries.
+ */
+
+#define REGSEQ_MAX_BURST 64
+
+/* 8 bit registers, address increments by one per byte */
+struct regseq8 {
+	u16 addr;
+	u8  val;
+};
+
+/* 16 bit words, address increments by one per word, little endian */
+struct regseq16 {
+	u32 addr;
+	u16 val;
+};
+
+static inline int regseq8_write(void *priv, const struct regseq8 *tab,
+				int n, int max,
+				int (*wr)(void *priv, u16 reg,
+					  const u8 *data, int len))
+{
+	u8 buf[REGSEQ_MAX_BURST];
+	int i, len, status;
+
+	if (max > REGSEQ_MAX_BURST)
+		max = REGSEQ_MAX_BURST;
+	for (i = 0; i < n; i += len) {
+		for (len = 0; i + len < n && len < max; len++) {
+			if (tab[i + len].addr != tab[i].addr + len)
+				break;
+			buf[len] = tab[i + len].val;
+		}
+		status = wr(priv, tab[i].addr, buf, len);
+		if (status < 0)
+			return status;
+	}
+	return 0;
+}
+
+static inline int regseq16_write(void *priv, const struct regseq16 *tab,
+				 int n, int max,
+				 int (*wr)(void *priv, u32 reg,
+					   const u8 *data, int len))
+{
+	u8 buf[REGSEQ_MAX_BURST];
+	int i, len, status;
+
+	max /= 2;
+	if (max > REGSEQ_MAX_BURST / 2)
+		max = REGSEQ_MAX_BURST / 2;
+	for (i = 0; i < n; i += len) {
+		for (len = 0; i + len < n && len < max; len++) {
+			if (tab[i + len].addr != tab[i].addr + len)
+				break;
+			buf[2 * len] = tab[i + len].val & 0xff;
+			buf[2 * len + 1] = tab[i + len].val >> 8;
+		}
+		status = wr(priv, tab[i].addr, buf, 2 * len);
+		if (status < 0)
+			return status;
+	}
+	return 0;
+}
+
+#endif
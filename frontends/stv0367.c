@@ -32,6 +32,7 @@
 #include "stv0367.h"
 #include "stv0367_regs.h"
 #include "stv0367_priv.h"
+#include "regseq.h"
 
 static int stvdebug;
 module_param_named(debug, stvdebug, int, 0644);
@@ -94,13 +95,8 @@ struct stv0367_state {
 	s32 IF;
 };
 
-struct st_register {
-	u16	addr;
-	u8	value;
-};
-
 /* values for STV4100 XTAL=30M int clk=53.125M*/
-static struct st_register def0367ter[STV0367TER_NBREGS] = {
+static const struct regseq8 def0367ter[STV0367TER_NBREGS] = {
 	{R367TER_ID,		0x60},
 	{R367TER_I2CRPT,	0x38},
 	/* {R367TER_I2CRPT,	0x22},*/
@@ -573,7 +569,7 @@ s32 stv0367cab_RF_LookUp2[RF_LOOKUP_TABLE2_SIZE][RF_LOOKUP_TABLE2_SIZE] = {
 	}
 };
 
-static struct st_register def0367cab[STV0367CAB_NBREGS] = {
+static const struct regseq8 def0367cab[STV0367CAB_NBREGS] = {
 	{R367CAB_ID,		0x60},
 	{R367CAB_I2CRPT,	0x38},
 	/*{R367CAB_I2CRPT,	0x22},*/
@@ -765,7 +761,8 @@ static struct st_register def0367cab[STV0367CAB_NBREGS] = {
 };
 
 static
-int stv0367_writeregs(struct stv0367_state *state, u16 reg, u8 *data, int len)
+int stv0367_writeregs(struct stv0367_state *state, u16 reg, const u8 *data,
+		      int len)
 {
 	u8 buf[len + 2];
 	struct i2c_msg msg = {
@@ -795,6 +792,18 @@ static int stv0367_writereg(struct stv0367_state *state, u16 reg, u8 data)
 	return stv0367_writeregs(state, reg, &data, 1);
 }
 
+static int stv0367_write_burst(void *priv, u16 reg, const u8 *data, int len)
+{
+	return stv0367_writeregs(priv, reg, data, len);
+}
+
+static int stv0367_write_table(struct stv0367_state *state,
+			       const struct regseq8 *tab, int n)
+{
+	return regseq8_write(state, tab, n, REGSEQ_MAX_BURST,
+			     stv0367_write_burst);
+}
+
 static u8 stv0367_readreg(struct stv0367_state *state, u16 reg)
 {
 	u8 b0[] = { 0, 0 };
@@ -1536,15 +1545,12 @@ int stv0367ter_init(struct dvb_frontend *fe)
 {
 	struct stv0367_state *state = fe->demodulator_priv;
 	struct stv0367ter_state *ter_state = state->ter_state;
-	int i;
 
 	dprintk("%s:\n", __func__);
 
 	ter_state->pBER = 0;
 
-	for (i = 0; i < STV0367TER_NBREGS; i++)
-		stv0367_writereg(state, def0367ter[i].addr,
-					def0367ter[i].value);
+	stv0367_write_table(state, def0367ter, STV0367TER_NBREGS);
 
 	switch (state->config->xtal) {
 		/*set internal freq to 53.125MHz */
@@ -2779,13 +2785,10 @@ int stv0367cab_init(struct dvb_frontend *fe)
 {
 	struct stv0367_state *state = fe->demodulator_priv;
 	struct stv0367cab_state *cab_state = state->cab_state;
-	int i;
 
 	dprintk("%s:\n", __func__);
 
-	for (i = 0; i < STV0367CAB_NBREGS; i++)
-		stv0367_writereg(state, def0367cab[i].addr,
-						def0367cab[i].value);
+	stv0367_write_table(state, def0367cab, STV0367CAB_NBREGS);
 
 	switch (state->config->ts_mode) {
 	case STV0367_DVBCI_CLOCK:
@@ -34,6 +34,7 @@
 #include <media/dvb_frontend.h>
 #include "stv0367dd.h"
 #include "stv0367dd_regs.h"
+#include "regseq.h"
 
 enum omode { OM_NONE, OM_DVBT, OM_DVBC, OM_QAM_ITU_C };
 enum {  QAM_MOD_QAM4 = 0,
@@ -102,12 +103,7 @@ struct stv_state {
 	u32   ber;
 };
 
-struct init_table {
-	u16  adr;
-	u8   data;
-};
-
-struct init_table base_init[] = {
+static const struct regseq8 base_init[] = {
 	{ R367_IOCFG0,     0x80 },
 	{ R367_DAC0R,      0x00 },
 	{ R367_IOCFG1,     0x00 },
@@ -130,10 +126,9 @@ struct init_table base_init[] = {
 	{ R367_PLLSETUP,   0x18 },
 	{ R367_DUAL_AD12,  0x04 },
 	{ R367_TSTBIST,    0x00 },
-	{ 0x0000,          0x00 }
 };
 
-struct init_table qam_init[] = {
+static const struct regseq8 qam_init[] = {
 	{ R367_QAM_CTRL_1,                  0x06 },// Orginal 0x04
 	{ R367_QAM_CTRL_2,                  0x03 },
 	{ R367_QAM_IT_STATUS1,              0x2b },
@@ -295,10 +290,9 @@ struct init_table qam_init[] = {
 	{ R367_QAM_T_O_ID_1,                0x00 },
 	{ R367_QAM_T_O_ID_2,                0x00 },
 	{ R367_QAM_T_O_ID_3,                0x00 },
-	{ 0x0000, 0x00 } // EOT
 };
 
-struct init_table ofdm_init[] = {
+static const struct regseq8 ofdm_init[] = {
 	//{R367_OFDM_ID                   ,0x60},
 	//{R367_OFDM_I2CRPT 				,0x22},
 	//{R367_OFDM_TOPCTRL				,0x02},
@@ -744,7 +738,6 @@ struct init_table ofdm_init[] = {
 	//{R367_OFDM_DEBUG_LT7			 ,0x00},
 	//{R367_OFDM_DEBUG_LT8			 ,0x00},
 	//{R367_OFDM_DEBUG_LT9			 ,0x00},
-	{ 0x0000, 0x00 } // EOT
 };
 
 static inline u32 MulDiv32(u32 a, u32 b, u32 c)
@@ -812,16 +805,19 @@ static int readregs(struct stv_state *state, u16 reg, u8 *val, int count)
 	return (i2c_transfer(state->i2c, msgs, 2) == 2) ? 0 : -1;
 }
 
-static int write_init_table(struct stv_state *state, struct init_table *tab)
+static int write_burst(void *priv, u16 reg, const u8 *data, int len)
 {
-	while (1) {
-		if (!tab->adr)
-			break;
-		if (writereg(state, tab->adr, tab->data) < 0)
-			return -1;
-		tab++;
-	}
-	return 0;
+	struct stv_state *state = priv;
+	u8 mm[REGSEQ_MAX_BURST + 2] = { (reg >> 8), reg & 0xff };
+
+	memcpy(mm + 2, data, len);
+	return i2c_write(state->i2c, state->adr, mm, len + 2);
+}
+
+static int write_init_table(struct stv_state *state,
+			    const struct regseq8 *tab, int n)
+{
+	return regseq8_write(state, tab, n, REGSEQ_MAX_BURST, write_burst);
 }
 
 static int qam_set_modulation(struct stv_state *state)
@@ -1451,11 +1447,11 @@ static int attach_init(struct stv_state *state)
 	printk("stv0367 found\n");
 
 	writereg(state, R367_TOPCTRL, 0x10);
-	write_init_table(state, base_init);
-	write_init_table(state, qam_init);
+	write_init_table(state, base_init, ARRAY_SIZE(base_init));
+	write_init_table(state, qam_init, ARRAY_SIZE(qam_init));
 
 	writereg(state, R367_TOPCTRL, 0x00);
-	write_init_table(state, ofdm_init);
+	write_init_table(state, ofdm_init, ARRAY_SIZE(ofdm_init));
 
 	writereg(state, R367_OFDM_GAIN_SRC1, 0x2A);
 	writereg(state, R367_OFDM_GAIN_SRC2, 0xD6);
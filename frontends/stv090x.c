@@ -35,6 +35,7 @@
 #include "stv090x_reg.h"
 #include "stv090x.h"
 #include "stv090x_priv.h"
+#include "regseq.h"
 
 /* Max transfer size done by I2C transfer functions */
 #define MAX_XFER_SIZE  64
@@ -257,7 +258,7 @@ static const struct stv090x_tab stv090x_rf_tab[] = {
 };
 
 
-static struct stv090x_reg stv0900_initval[] = {
+static const struct regseq8 stv0900_initval[] = {
 
 	{ STV090x_OUTCFG,		0x00 },
 	{ STV090x_MODECFG,		0xff },
@@ -423,7 +424,7 @@ static struct stv090x_reg stv0900_initval[] = {
 	{ STV090x_P2_PRVIT,		0x2F }, /* disable PR 6/7 */
 };
 
-static struct stv090x_reg stv0903_initval[] = {
+static const struct regseq8 stv0903_initval[] = {
 	{ STV090x_OUTCFG,		0x00 },
 	{ STV090x_AGCRF1CFG,		0x11 },
 	{ STV090x_STOPCLK1,		0x48 },
@@ -525,7 +526,7 @@ static struct stv090x_reg stv0903_initval[] = {
 	{ STV090x_P1_PRVIT,		0x2f }  /*disable puncture rate 6/7*/
 };
 
-static struct stv090x_reg stv0900_cut20_val[] = {
+static const struct regseq8 stv0900_cut20_val[] = {
 
 	{ STV090x_P2_DMDCFG3,		0xe8 },
 	{ STV090x_P2_DMDCFG4,		0x10 },
@@ -561,7 +562,7 @@ static struct stv090x_reg stv0900_cut20_val[] = {
 	{ STV090x_GAINLLR_NF17,		0x21 },
 };
 
-static struct stv090x_reg stv0903_cut20_val[] = {
+static const struct regseq8 stv0903_cut20_val[] = {
 	{ STV090x_P1_DMDCFG3,		0xe8 },
 	{ STV090x_P1_DMDCFG4,		0x10 },
 	{ STV090x_P1_CARFREQ,		0x38 },
@@ -726,7 +727,7 @@ static int stv090x_read_reg(struct stv090x_state *state, unsigned int reg)
 	return (unsigned int) buf;
 }
 
-static int stv090x_write_regs(struct stv090x_state *state, unsigned int reg, u8 *data, u32 count)
+static int stv090x_write_regs(struct stv090x_state *state, unsigned int reg, const u8 *data, u32 count)
 {
 	const struct stv090x_config *config = state->config;
 	int ret;
@@ -770,6 +771,18 @@ static int stv090x_write_reg(struct stv090x_state *state, unsigned int reg, u8 d
 	return stv090x_write_regs(state, reg, &data, 1);
 }
 
+static int stv090x_write_burst(void *priv, u16 reg, const u8 *data, int len)
+{
+	return stv090x_write_regs(priv, reg, data, len);
+}
+
+static int stv090x_write_table(struct stv090x_state *state,
+			       const struct regseq8 *tab, int n)
+{
+	return regseq8_write(state, tab, n, MAX_XFER_SIZE - 2,
+			     stv090x_write_burst);
+}
+
 static int stv090x_i2c_gate_ctrl(struct stv090x_state *state, int enable)
 {
 	u32 reg;
@@ -4939,13 +4952,11 @@ static int stv090x_setup(struct dvb_frontend *fe)
 {
 	struct stv090x_state *state = fe->demodulator_priv;
 	const struct stv090x_config *config = state->config;
-	const struct stv090x_reg *stv090x_initval = NULL;
-	const struct stv090x_reg *stv090x_cut20_val = NULL;
+	const struct regseq8 *stv090x_initval = NULL;
+	const struct regseq8 *stv090x_cut20_val = NULL;
 	unsigned long t1_size = 0, t2_size = 0;
 	u32 reg = 0;
 
-	int i;
-
 	if (state->device == STV0900) {
 		dprintk(FE_DEBUG, 1, "Initializing STV0900");
 		stv090x_initval = stv0900_initval;
@@ -4997,10 +5008,8 @@ static int stv090x_setup(struct dvb_frontend *fe)
 
 	/* write initval */
 	dprintk(FE_DEBUG, 1, "Setting up initial values");
-	for (i = 0; i < t1_size; i++) {
-		if (stv090x_write_reg(state, stv090x_initval[i].addr, stv090x_initval[i].data) < 0)
-			goto err;
-	}
+	if (stv090x_write_table(state, stv090x_initval, t1_size) < 0)
+		goto err;
 
 	state->internal->dev_ver = stv090x_read_reg(state, STV090x_MID);
 	if (state->internal->dev_ver >= 0x20) {
@@ -5009,10 +5018,8 @@ static int stv090x_setup(struct dvb_frontend *fe)
 
 		/* write cut20_val*/
 		dprintk(FE_DEBUG, 1, "Setting up Cut 2.0 initial values");
-		for (i = 0; i < t2_size; i++) {
-			if (stv090x_write_reg(state, stv090x_cut20_val[i].addr, stv090x_cut20_val[i].data) < 0)
-				goto err;
-		}
+		if (stv090x_write_table(state, stv090x_cut20_val, t2_size) < 0)
+			goto err;
 
 	} else if (state->internal->dev_ver < 0x20) {
 		dprintk(FE_ERROR, 1, "ERROR: Unsupported Cut: 0x%02x!",
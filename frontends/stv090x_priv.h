@@ -220,11 +220,6 @@ struct stv090x_short_frame_crloop {
 	u8 crl_30; /* 10 < SR <= 45M */
 };
 
-struct stv090x_reg {
-	u16 addr;
-	u8  data;
-};
-
 struct stv090x_tab {
 	s32 real;
 	s32 read;
@@ -91,6 +91,10 @@ struct stv_base {
 
 	u32                  extclk;
 	u32                  mclk;
+
+	/* last written values of the registers in shadow_regs[] */
+	u8                   shadow[20];
+	unsigned long        shadow_valid;
 };
 
 struct stv {
@@ -142,13 +146,56 @@ struct slookup {
 	u16  reg_value;
 };
 
+/* Configuration registers which are only changed by the driver and
+ * modified with write_field()/write_shared_reg(). Their last written
+ * value is kept in base->shadow so the read-modify-write does not need
+ * an I2C read. Status registers must never be added here.
+ */
+static const u16 shadow_regs[] = {
+	RSTV0910_P1_PDELCTRL0, RSTV0910_P1_PDELCTRL1, RSTV0910_P1_PDELCTRL2,
+	RSTV0910_P1_TSSTATEM, RSTV0910_P1_TSCFGL, RSTV0910_P1_TSINSDELH,
+	RSTV0910_P1_TSINSDELM, RSTV0910_P1_TSDLYSET2, RSTV0910_P1_DISRXCFG,
+	RSTV0910_P2_PDELCTRL0, RSTV0910_P2_PDELCTRL1, RSTV0910_P2_PDELCTRL2,
+	RSTV0910_P2_TSSTATEM, RSTV0910_P2_TSCFGL, RSTV0910_P2_TSINSDELH,
+	RSTV0910_P2_TSINSDELM, RSTV0910_P2_TSDLYSET2, RSTV0910_P2_DISRXCFG,
+	RSTV0910_TSTTSRS,
+};
+
+static int shadow_index(u16 reg)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(shadow_regs); i++)
+		if (shadow_regs[i] == reg)
+			return i;
+	return -1;
+}
+
+static void shadow_update(struct stv *state, u16 reg, u8 val, int valid)
+{
+	struct stv_base *base = state->base;
+	int i = shadow_index(reg);
+
+	if (i < 0)
+		return;
+	if (valid) {
+		base->shadow[i] = val;
+		set_bit(i, &base->shadow_valid);
+	} else {
+		clear_bit(i, &base->shadow_valid);
+	}
+}
+
 static int write_reg(struct stv *state, u16 reg, u8 val)
 {
 	u8 data[3] = {reg >> 8, reg & 0xff, val};
 	struct i2c_msg msg = {.addr = state->base->adr, .flags = 0,
 			      .buf = data, .len = 3};
+	int status;
 
-	return (i2c_transfer(state->base->i2c, &msg, 1) == 1) ? 0 : -1;
+	status = (i2c_transfer(state->base->i2c, &msg, 1) == 1) ? 0 : -1;
+	shadow_update(state, reg, val, !status);
+	return status;
 }
 
 #if 0
@@ -180,13 +227,32 @@ static int read_reg(struct stv *state, u16 reg, u8 *val)
 	return read_regs(state, reg, val, 1);
 }
 
+/* Current value of a register which is about to be modified.
+ * Comes from the shadow if possible, otherwise from the chip.
+ */
+static int read_reg_cached(struct stv *state, u16 reg, u8 *val)
+{
+	struct stv_base *base = state->base;
+	int i = shadow_index(reg);
+	int status;
+
+	if (i >= 0 && test_bit(i, &base->shadow_valid)) {
+		*val = base->shadow[i];
+		return 0;
+	}
+	status = read_reg(state, reg, val);
+	if (!status)
+		shadow_update(state, reg, *val, 1);
+	return status;
+}
+
 static int write_shared_reg(struct stv *state, u16 reg, u8 mask, u8 val)
 {
 	int status;
 	u8 tmp;
 
 	mutex_lock(&state->base->reg_lock);
-	status = read_reg(state, reg, &tmp);
+	status = read_reg_cached(state, reg, &tmp);
 	if (!status)
 		status = write_reg(state, reg, (tmp & ~mask) | (val & mask));
 	mutex_unlock(&state->base->reg_lock);
@@ -198,7 +264,7 @@ static int write_field(struct stv *state, u32 field, u8 val)
 	int status;
 	u8 shift, mask, old, new;
 
-	status = read_reg(state, field >> 16, &old);
+	status = read_reg_cached(state, field >> 16, &old);
 	if (status)
 		return status;
 	mask = field & 0xff;
@@ -1145,8 +1211,10 @@ static int probe(struct stv *state)
 {
 	u8 id;
 
+	BUILD_BUG_ON(ARRAY_SIZE(shadow_regs) > sizeof(state->base->shadow));
 	state->receive_mode = RCVMODE_NONE;
 	state->started = 0;
+	state->base->shadow_valid = 0;
 
 	if (read_reg(state, RSTV0910_MID, &id) < 0)
 		return -EINVAL;
@@ -1409,14 +1477,19 @@ static int read_status(struct dvb_frontend *fe, enum fe_status *status)
 	u16 val;
 	u32 ber;
 	s32 foff;
+	/* DMDMODCOD ... DMDSTATE in one transfer */
+	u8 sreg[RSTV0910_P2_DMDSTATE - RSTV0910_P2_DMDMODCOD + 1];
+
+#define SREG(_reg) sreg[RSTV0910_P2_##_reg - RSTV0910_P2_DMDMODCOD]
 
 	*status = 0;
-	read_reg(state, RSTV0910_P2_DMDSTATE + state->regoff, &dmdstate);
+	if (read_regs(state, RSTV0910_P2_DMDMODCOD + state->regoff,
+		      sreg, sizeof(sreg)))
+		memset(sreg, 0, sizeof(sreg));
+	dmdstate = SREG(DMDSTATE);
 	if (dmdstate & 0x40) {
-		u8 dstatus  = 0;
+		u8 dstatus = SREG(DSTATUS);
 
-		read_reg(state, RSTV0910_P2_DSTATUS + state->regoff,
-			 &dstatus);
 		if (dstatus & 0x08)
 			cur_receive_mode = (dmdstate & 0x20) ?
 				RCVMODE_DVBS : RCVMODE_DVBS2;
@@ -1506,9 +1579,8 @@ static int read_status(struct dvb_frontend *fe, enum fe_status *status)
 				write_reg(state,
 					  RSTV0910_P2_DEMOD + state->regoff,
 					  state->demod);
-				read_reg(state,
-					 RSTV0910_P2_PDELCTRL2 + state->regoff,
-					 &tmp);
+				read_reg_cached(state, RSTV0910_P2_PDELCTRL2 +
+						state->regoff, &tmp);
 				/*reset DVBS2 packet delinator error counter */
 				tmp |= 0x40;
 				write_reg(state, RSTV0910_P2_PDELCTRL2 +
@@ -1550,12 +1622,10 @@ static int read_status(struct dvb_frontend *fe, enum fe_status *status)
 		}
 		/* Use highest signaled ModCod for quality */
 		if (state->is_vcm) {
-			u8 tmp;
 			enum fe_stv0910_modcod modcod;
 
-			read_reg(state, RSTV0910_P2_DMDMODCOD + state->regoff,
-				 &tmp);
-			modcod = (enum fe_stv0910_modcod)((tmp & 0x7c) >> 2);
+			modcod = (enum fe_stv0910_modcod)
+				((SREG(DMDMODCOD) & 0x7c) >> 2);
 
 			if (modcod > state->modcod)
 				state->modcod = modcod;
@@ -1578,6 +1648,7 @@ get_stat:
 	}
 	get_frequency_offset(state, &foff);
 	return 0;
+#undef SREG
 }
 
 static int tune(struct dvb_frontend *fe, bool re_tune,
@@ -154,6 +154,9 @@ struct dmx_filter {
  *	  has been delivered;
  *	- %DMX_IMMEDIATE_START - Start filter immediately without requiring a
  *	  :ref:`DMX_START`.
+ *	- %DMX_CHANGED_ONLY - only deliver sections which are new or differ
+ *	  in version or CRC from the last delivered section with the same
+ *	  table_id, table_id_extension and section_number.
  */
 struct dmx_sct_filter_params {
 	__u16             pid;
@@ -163,6 +166,7 @@ struct dmx_sct_filter_params {
 #define DMX_CHECK_CRC       1
 #define DMX_ONESHOT         2
 #define DMX_IMMEDIATE_START 4
+#define DMX_CHANGED_ONLY    8
 };
 
 /**
@@ -174,6 +178,12 @@ struct dmx_sct_filter_params {
  * @output:	Demux output, as specified by &enum dmx_output.
  * @pes_type:	Type of the pes filter, as specified by &enum dmx_pes_type.
  * @flags:	Demux PES flags.
+ *
+ * Besides %DMX_IMMEDIATE_START the @flags can be:
+ *
+ *	- %DMX_TIMESTAMPS - for TS outputs, precede the data of every new
+ *	  hardware DMA block with a null packet carrying a timestamp record,
+ *	  see &struct dmx_ts_record.
  */
 struct dmx_pes_filter_params {
 	__u16           pid;
@@ -181,8 +191,33 @@ struct dmx_pes_filter_params {
 	enum dmx_output output;
 	enum dmx_ts_pes pes_type;
 	__u32           flags;
+#define DMX_TIMESTAMPS      16
 };
 
+/**
+ * struct dmx_ts_record - timestamp record inserted by %DMX_TIMESTAMPS
+ *
+ * @header:	TS header of a null packet: 0x47 0x1f 0xff 0x10.
+ * @magic:	"DDBT".
+ * @block_time:	CLOCK_MONOTONIC time in ns at which the driver first saw
+ *		the following DMA block completed, normally in the
+ *		interrupt handler.
+ * @demux_time:	CLOCK_MONOTONIC time in ns when the demux passed the
+ *		block to the output buffer.
+ * @pad:	stuffing, 0xff.
+ *
+ * All values are big endian. The record fills exactly one TS packet, so
+ * TS parsers which do not know it drop it as a null packet. The time at
+ * which the reader gets the packet completes the latency picture.
+ */
+struct dmx_ts_record {
+	__u8  header[4];
+	__u8  magic[4];
+	__u64 block_time;
+	__u64 demux_time;
+	__u8  pad[164];
+} __attribute__((packed));
+
 /**
  * struct dmx_stc - Stores System Time Counter (STC) information.
  *
@@ -25,6 +25,20 @@ struct dvb_ns_params {
 #define DVB_NS_RTP_TO  0x08
 #define DVB_NS_VLAN    0x10
 
+/* one entry of NS_SET_NET_BATCH, fd is an open netstream device */
+struct dvb_ns_net {
+	__s32    fd;
+	__u32    reserved;
+	struct dvb_ns_params params;
+};
+
+#define DVB_NS_BATCH_MAX 256
+
+struct dvb_ns_net_batch {
+	struct dvb_ns_net *net;
+	__u32    num;
+};
+
 struct dvb_ns_rtcp {
 	__u8    *msg;
 	__u16    len;
@@ -50,6 +64,17 @@ struct dvb_nsd_ts {
 	__u16	 section_id;
 };
 
+/* completed NSD_QUEUE_GET_TS capture, returned by read() on the nsd device */
+struct dvb_nsd_result {
+	__u32    id;
+	__s32    status;
+	__u16    input;
+	__u16    pid;
+	__u16    len;
+	__u16    reserved;
+	__u8     data[4096];
+};
+
 struct dvb_ns_cap {
 	__u8     streams_max;
 	__u8     reserved[127];
@@ -66,6 +91,9 @@ struct dvb_ns_cap {
 #define NSD_STOP_GET_TS          _IOWR('o', 199, struct dvb_nsd_ts)
 #define NSD_CANCEL_GET_TS        _IO('o', 200)
 #define NSD_POLL_GET_TS          _IOWR('o', 201, struct dvb_nsd_ts)
+#define NSD_QUEUE_GET_TS         _IOW('o', 205, struct dvb_nsd_ts)
+
+#define NS_SET_NET_BATCH         _IOW('o', 206, struct dvb_ns_net_batch)
 
 #define NS_SET_PACKETS           _IOW('o', 202, struct dvb_ns_packet)
 #define NS_INSERT_PACKETS	 _IOW('o', 203, __u8)
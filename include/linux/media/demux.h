@@ -547,6 +547,15 @@ enum dmx_demux_caps {
  *	0 on success;
  *	-EINVAL on bad parameter.
  *
+ * @block_time: CLOCK_MONOTONIC time in ns at which the hardware completed
+ *	the data currently fed into the demux, or 0 if unknown. Set by the
+ *	driver around the dvb_dmx_swfilter*() calls; used by %DMX_TIMESTAMPS.
+ *
+ * @block_done: optional, called with @block_done_priv after each
+ *	dvb_dmx_swfilter*() call once the demux lock is released. Lets
+ *	consumers such as dvb_net hand data on once per block instead of
+ *	from the filter callbacks, which run with interrupts disabled.
+ *
  * @get_pes_pids: Get the PIDs for DMX_PES_AUDIO0, DMX_PES_VIDEO0,
  *	DMX_PES_TELETEXT0, DMX_PES_SUBTITLE0 and DMX_PES_PCR0.
  *	The @demux function parameter contains a pointer to the demux API and
@@ -586,6 +595,11 @@ struct dmx_demux {
 
 	int (*get_pes_pids)(struct dmx_demux *demux, u16 *pids);
 
+	u64 block_time;
+
+	void (*block_done)(void *priv);
+	void *block_done_priv;
+
 	/* private: */
 
 	/*
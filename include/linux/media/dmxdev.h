@@ -89,6 +89,30 @@ struct dmxdev_feed {
 	struct list_head next;
 };
 
+/**
+ * struct dmxdev_sec_cache - identity of a delivered section
+ *
+ * @crc:	CRC32 (last four bytes) of the section.
+ * @ext:	table_id_extension of the section.
+ * @table_id:	table_id of the section.
+ * @secnum:	section_number of the section.
+ * @version:	version_number of the section.
+ * @valid:	entry holds a delivered section.
+ *
+ * Used by section filters with %DMX_CHANGED_ONLY to suppress
+ * repetitions of unchanged sections.
+ */
+struct dmxdev_sec_cache {
+	u32 crc;
+	u16 ext;
+	u8 table_id;
+	u8 secnum;
+	u8 version;
+	u8 valid;
+};
+
+#define DMXDEV_SEC_CACHE_SIZE 256
+
 /**
  * struct dmxdev_filter - digital TV dmxdev filter
  *
@@ -123,6 +147,11 @@ struct dmxdev_feed {
  *		Only for section filter.
  * @secheader:	buffer cache to parse the section header.
  *		Only for section filter.
+ * @sec_cache:	direct mapped cache of delivered sections, allocated
+ *		when %DMX_CHANGED_ONLY is requested.
+ *		Only for section filter.
+ * @block_time:	block time of the last timestamp record written to
+ *		@buffer, for %DMX_TIMESTAMPS.
  */
 struct dmxdev_filter {
 	union {
@@ -154,6 +183,8 @@ struct dmxdev_filter {
 	struct timer_list timer;
 	int todo;
 	u8 secheader[3];
+	struct dmxdev_sec_cache *sec_cache;
+	u64 block_time;
 };
 
 /**
@@ -174,6 +205,8 @@ struct dmxdev_filter {
  * @dvr_vb2_ctx:	control struct for VB2 handler
  * @mutex:		protects the usage of this structure.
  * @lock:		protects access to &dmxdev->filter->data.
+ * @dvr_block_time:	block time of the last timestamp record written to
+ *			@dvr_buffer, for %DMX_TIMESTAMPS.
  */
 struct dmxdev {
 	struct dvb_device *dvbdev;
@@ -199,6 +232,7 @@ struct dmxdev {
 
 	struct mutex mutex;
 	spinlock_t lock;
+	u64 dvr_block_time;
 };
 
 /**
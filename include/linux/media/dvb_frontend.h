@@ -393,6 +393,11 @@ struct dvb_frontend_internal_info {
  *			an error code if the statistics are not available
  *			because the demog is not locked.
  * @read_status:	returns the locking status of the frontend.
+ * @update_stats:	reads the signal statistics into
+ *			&struct dvb_frontend.dtv_property_cache. Called by the
+ *			frontend thread every dvb_stats_interval milliseconds,
+ *			independent of how often @read_status is polled. Drivers
+ *			providing it should keep @read_status to lock detection.
  * @read_ber:		legacy callback function to return the bit error rate.
  *			Newer drivers should provide such info via DVBv5 API,
  *			e. g. @set_frontend;/@get_frontend, implementing this
@@ -475,6 +480,7 @@ struct dvb_frontend_ops {
 			    struct dtv_frontend_properties *props);
 
 	int (*read_status)(struct dvb_frontend *fe, enum fe_status *status);
+	int (*update_stats)(struct dvb_frontend *fe);
 	int (*read_ber)(struct dvb_frontend* fe, u32* ber);
 	int (*read_signal_strength)(struct dvb_frontend* fe, u16* strength);
 	int (*read_snr)(struct dvb_frontend* fe, u16* snr);
@@ -815,6 +821,17 @@ int dvb_frontend_resume(struct dvb_frontend *fe);
  */
 void dvb_frontend_reinitialise(struct dvb_frontend *fe);
 
+/**
+ * dvb_frontend_cached_status() - last status seen by the frontend thread
+ *
+ * @fe: pointer to &struct dvb_frontend
+ *
+ * Returns the status of the last &dvb_frontend_ops.read_status\(\) call
+ * of the frontend thread without accessing the hardware, 0 while the
+ * frontend is idle or not opened.
+ */
+enum fe_status dvb_frontend_cached_status(struct dvb_frontend *fe);
+
 /**
  * dvb_frontend_sleep_until() - Sleep for the amount of time given by
  *                      add_usec parameter
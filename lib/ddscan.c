@@ -0,0 +1,140 @@
+#include "../include/linux/dvb/frontend.h"
+#include "src/libdddvb.h"
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define MAX_CARRIERS 512
+
+int main(int argc, char **argv)
+{
+	struct dddvb *dd;
+	struct dddvb_fe *fe;
+	struct dddvb_scan_params sp;
+	struct dddvb_carrier *car;
+	uint32_t num = DDDVB_UNDEF, verbosity = 0, spectrum = 0, i;
+	char *config = "config/";
+	int n;
+
+	dddvb_scan_params_init(&sp);
+	while (1) {
+		int option_index = 0;
+		int c;
+		static struct option long_options[] = {
+			{"config", required_argument, 0, 'c'},
+			{"num", required_argument, 0, 'n'},
+			{"polarity", required_argument, 0, 'p'},
+			{"source", required_argument, 0, 'l'},
+			{"start", required_argument, 0, 'f'},
+			{"end", required_argument, 0, 'e'},
+			{"threshold", required_argument, 0, 't'},
+			{"averages", required_argument, 0, 'a'},
+			{"fftsize", required_argument, 0, 'z'},
+			{"confirm", required_argument, 0, 'C'},
+			{"spectrum", no_argument, 0, 'S'},
+			{"verbosity", required_argument, 0, 'v'},
+			{"help", no_argument , 0, 'h'},
+			{0, 0, 0, 0}
+		};
+		c = getopt_long(argc, argv, "c:n:p:l:f:e:t:a:z:C:Sv:h",
+				long_options, &option_index);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'c':
+			config = strdup(optarg);
+			break;
+		case 'n':
+			num = strtoul(optarg, NULL, 0);
+			break;
+		case 'p':
+			if (!strcmp(optarg, "h") || !strcmp(optarg, "H"))
+				sp.pol = 1;
+			if (!strcmp(optarg, "v") || !strcmp(optarg, "V"))
+				sp.pol = 0;
+			break;
+		case 'l':
+			sp.src = strtoul(optarg, NULL, 0);
+			break;
+		case 'f':
+			sp.freq_start = strtoul(optarg, NULL, 0);
+			break;
+		case 'e':
+			sp.freq_end = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			sp.threshold = strtod(optarg, NULL) * 10;
+			break;
+		case 'a':
+			sp.averages = strtoul(optarg, NULL, 0);
+			break;
+		case 'z':
+			sp.fft_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'C':
+			sp.confirm_ms = strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			spectrum = 1;
+			break;
+		case 'v':
+			verbosity = strtoul(optarg, NULL, 0);
+			break;
+		case 'h':
+			fprintf(stderr,
+				"ddscan [-c config_dir] [-n device_num] [-p polarity] [-l source]\n"
+				"       [-f start(kHz)] [-e end(kHz)] [-t threshold(dB)]\n"
+				"       [-a averages] [-z fft_size] [-C confirm_time(ms), 0 = off]\n"
+				"       [-S (print spectrum)] [-v verbosity]\n"
+				"\n"
+				"       needs a MaxSX8 frontend, polarity = h/H,v/V\n"
+				"\n");
+			exit(-1);
+		default:
+			break;
+		}
+	}
+	sp.get_spectrum = spectrum;
+
+	car = calloc(MAX_CARRIERS, sizeof(*car));
+	if (!car)
+		exit(-1);
+	dd = dddvb_init(config, verbosity);
+	if (!dd) {
+		fprintf(stderr, "dddvb_init failed\n");
+		exit(-1);
+	}
+	dddvb_get_ts(dd, 0);
+	if (num != DDDVB_UNDEF)
+		fe = dddvb_fe_alloc_num(dd, SYS_DVBS2, num);
+	else
+		fe = dddvb_fe_alloc(dd, SYS_DVBS2);
+	if (!fe) {
+		fprintf(stderr, "dddvb_fe_alloc failed\n");
+		exit(-1);
+	}
+	n = dddvb_scan(fe, &sp, car, MAX_CARRIERS);
+	if (n < 0) {
+		fprintf(stderr, "scan failed: %s\n", strerror(-n));
+		exit(-1);
+	}
+	if (sp.spectrum) {
+		for (i = 0; i < sp.spectrum_len; i++)
+			if (sp.spectrum[i] != INT16_MIN)
+				printf("# %.3f %.1f\n",
+				       sp.freq_start + i * (double) sp.spectrum_step / 1000.0,
+				       sp.spectrum[i] / 10.0);
+		free(sp.spectrum);
+	}
+	printf("# freq(kHz) sr(Hz) level(dB) lock\n");
+	for (i = 0; i < n; i++)
+		printf("%u %u %.1f %u\n", car[i].freq, car[i].sr,
+		       car[i].level / 10.0, car[i].lock);
+	dddvb_fe_release(fe);
+	free(car);
+	return 0;
+}
@@ -16,6 +16,7 @@
 #include <time.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <poll.h>
 
 char line_start[16] = "";
 char line_end[16]   = "\r";
@@ -325,10 +326,12 @@ ssize_t rread(int fd, uint8_t *buf, size_t count)
 static void decode(struct dddvb *dd, int fd)
 {
 	uint8_t buf[200*188];
+	uint8_t obuf[200*188];
 	uint8_t ts[188];
 	struct dvbf_pid pidf[16];
-	int pmt;
-	ssize_t len, len2;
+	struct pollfd pfd;
+	int pmt, sfd;
+	ssize_t len, len2, off;
 	uint32_t count = 0;
 	
 	for (pmt = 0; pmt < numpmt; pmt++) {
@@ -351,6 +354,13 @@ static void decode(struct dddvb *dd, int fd)
 	//sleep(10);
 	while (dddvb_ca_set_pmts(dd, ci, pmts) < 0)
 		sleep(1);
+	sfd = dddvb_ca_stream_start(dd, ci);
+	if (sfd < 0) {
+		dprintf(2, "Could not start CI stream %d\n", sfd);
+		exit(-1);
+	}
+	pfd.fd = sfd;
+	pfd.events = POLLIN;
 	while (1) {
 		len = rread(fd, buf, sizeof(buf));
 		if (len < 0) {
@@ -361,15 +371,17 @@ static void decode(struct dddvb *dd, int fd)
 			rread(fd, buf, 1);
 			continue;
 		}
-		len2 = dddvb_ca_write(dd, ci, buf, len);
-		if (len2 != len)
-			dprintf(2, "Written less to CI %d\n", len);
-		len = dddvb_ca_read(dd, ci, buf, len2);
-		if (len < 0)
-			continue;
-		len2 = write(fileno(stdout), buf, len);
-		if (len2 != len)
-			dprintf(2, "Written less to output %d\n", len);
+		for (off = 0; ; ) {
+			len2 = dddvb_ca_stream_write(dd, ci, buf + off, len - off);
+			if (len2 > 0)
+				off += len2;
+			while ((len2 = dddvb_ca_stream_read(dd, ci, obuf, sizeof(obuf))) > 0)
+				if (write(fileno(stdout), obuf, len2) != len2)
+					dprintf(2, "Written less to output %d\n", len2);
+			if (off >= len)
+				break;
+			poll(&pfd, 1, 10);
+		}
 	}
 }
 
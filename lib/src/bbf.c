@@ -0,0 +1,477 @@
+#include "libdddvb.h"
+#include "dddvb.h"
+#include "debug.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+/*
+ * BBFrame reassembly from the TS embedding of docs/bbframes.
+ *
+ * Packets of PID 0x010E are copied straight into the next free slot of a
+ * preallocated frame ring, the BBHeader CRC8 is checked on the header
+ * packet. Complete frames are published to a single consumer, which reads
+ * them in place with dddvb_bbf_get() and hands them back with
+ * dddvb_bbf_release(). If the consumer falls behind, new frames are
+ * dropped and counted.
+ *
+ * Optionally the data field of generic continuous streams is parsed as
+ * GSE (ETSI TS 102 606-1) and the PDUs are passed to a callback, e.g. one
+ * writing IP packets to a TUN device.
+ */
+
+static uint8_t crc8_tab[256];
+static uint32_t crc32_tab[256];
+
+void dddvb_crc_init(void)
+{
+	uint32_t i, j, c;
+
+	if (crc8_tab[1])
+		return;
+	for (i = 0; i < 256; i++) {
+		/* DVB-S2 CRC-8, g(x) = x^8 + x^7 + x^6 + x^4 + x^2 + 1 */
+		for (c = i, j = 0; j < 8; j++)
+			c = ((c << 1) ^ ((c & 0x80) ? 0xd5 : 0)) & 0xff;
+		crc8_tab[i] = c;
+		for (c = i << 24, j = 0; j < 8; j++)
+			c = (c << 1) ^ ((c & 0x80000000) ? 0x04c11db7 : 0);
+		crc32_tab[i] = c;
+	}
+}
+
+uint8_t dddvb_crc8(const uint8_t *p, uint32_t len)
+{
+	uint8_t crc = 0;
+
+	while (len--)
+		crc = crc8_tab[crc ^ *p++];
+	return crc;
+}
+
+uint32_t dddvb_crc32(const uint8_t *p, uint32_t len)
+{
+	uint32_t crc = 0xffffffff;
+
+	while (len--)
+		crc = (crc << 8) ^ crc32_tab[((crc >> 24) ^ *p++) & 0xff];
+	return crc;
+}
+
+static void bbf_signal(int fd)
+{
+	uint64_t one = 1;
+
+	if (write(fd, &one, sizeof(one)) < 0)
+		return;
+}
+
+static struct dddvb_bbframe *bbf_cur(struct dddvb_bbf *bbf)
+{
+	return &bbf->frame[bbf->wp & (bbf->nframes - 1)];
+}
+
+/* GSE */
+
+static void gse_deliver(struct dddvb_bbf *bbf, uint32_t lt,
+			const uint8_t *p, uint32_t len)
+{
+	static const uint8_t label_len[4] = { 6, 3, 0, 0 };
+	uint16_t proto;
+
+	if (len < 2 + label_len[lt]) {
+		bbf->gse_errors++;
+		return;
+	}
+	proto = (p[0] << 8) | p[1];
+	p += 2 + label_len[lt];
+	len -= 2 + label_len[lt];
+	bbf->gse_pdus++;
+	bbf->gse_cb(bbf->gse_priv, proto, p, len);
+}
+
+static struct dddvb_gse_frag *gse_frag(struct dddvb_bbf *bbf, uint32_t key,
+				       int new)
+{
+	struct dddvb_gse_frag *f, *old = &bbf->frag[0];
+	int i;
+
+	for (i = 0; i < DDDVB_GSE_FRAGS; i++) {
+		f = &bbf->frag[i];
+		if (f->used && f->key == key)
+			break;
+		if (!f->used || (old->used && f->age < old->age))
+			old = f;
+	}
+	if (i == DDDVB_GSE_FRAGS) {
+		if (!new)
+			return NULL;
+		f = old;
+	}
+	if (new) {
+		if (f->used)
+			bbf->gse_errors++;
+		f->used = 1;
+		f->key = key;
+		f->len = 0;
+	}
+	f->age = bbf->gse_age;
+	return f;
+}
+
+static void gse_frame(struct dddvb_bbf *bbf, const struct dddvb_bbframe *fr)
+{
+	const uint8_t *d = fr->data + 10, *q;
+	uint32_t n = fr->dfl / 8, pos, glen, s, e, lt, key;
+	struct dddvb_gse_frag *f;
+
+	bbf->gse_age++;
+	for (pos = 0; pos + 2 <= n; pos += 2 + glen) {
+		s = d[pos] >> 7;
+		e = (d[pos] >> 6) & 1;
+		lt = (d[pos] >> 4) & 3;
+		glen = ((d[pos] & 0x0f) << 8) | d[pos + 1];
+		if (!s && !e && !lt)
+			break;          /* padding up to the end of the frame */
+		if (pos + 2 + glen > n) {
+			bbf->gse_errors++;
+			break;
+		}
+		q = d + pos + 2;
+		if (s && e) {
+			gse_deliver(bbf, lt, q, glen);
+			continue;
+		}
+		if (glen < 1) {
+			bbf->gse_errors++;
+			continue;
+		}
+		key = (fr->isi << 8) | q[0];
+		f = gse_frag(bbf, key, s);
+		if (!f) {
+			bbf->gse_errors++;
+			continue;
+		}
+		if (s) {
+			/* total length field is part of the CRC */
+			if (glen < 3) {
+				f->used = 0;
+				bbf->gse_errors++;
+				continue;
+			}
+			f->lt = lt;
+			f->total = ((q[1] << 8) | q[2]) + 2;
+		}
+		if (f->len + glen - 1 > DDDVB_GSE_MAX_PDU + 6) {
+			f->used = 0;
+			bbf->gse_errors++;
+			continue;
+		}
+		memcpy(f->buf + f->len, q + 1, glen - 1);
+		f->len += glen - 1;
+		if (!e)
+			continue;
+		f->used = 0;
+		if (f->len != f->total + 4 ||
+		    dddvb_crc32(f->buf, f->total) !=
+		    (uint32_t) ((f->buf[f->total] << 24) | (f->buf[f->total + 1] << 16) |
+				(f->buf[f->total + 2] << 8) | f->buf[f->total + 3])) {
+			bbf->gse_errors++;
+			continue;
+		}
+		gse_deliver(bbf, f->lt, f->buf + 2, f->total - 2);
+	}
+}
+
+/* BBFrames */
+
+static int bbf_header(struct dddvb_bbf *bbf, struct dddvb_bbframe *fr)
+{
+	const uint8_t *h = fr->data;
+	uint8_t crc = dddvb_crc8(h, 9);
+
+	if (h[9] == crc)
+		fr->hem = 0;
+	else if (h[9] == (crc ^ 1))
+		fr->hem = 1;
+	else
+		return -1;
+	fr->matype1 = h[0];
+	fr->isi = h[1];
+	fr->upl = (h[2] << 8) | h[3];
+	fr->dfl = (h[4] << 8) | h[5];
+	fr->sync = h[6];
+	fr->syncd = (h[7] << 8) | h[8];
+	return 0;
+}
+
+static void bbf_done(struct dddvb_bbf *bbf)
+{
+	struct dddvb_bbframe *fr = bbf_cur(bbf);
+	uint32_t tsgs = fr->matype1 >> 6;
+
+	bbf->cnt = -1;
+	if (fr->len < 10 + fr->dfl / 8) {
+		bbf->seq_errors++;
+		return;
+	}
+	fr->len = 10 + (fr->dfl + 7) / 8;
+	bbf->frames++;
+	/* generic continuous, GSE-HEM */
+	if (bbf->gse_cb && (tsgs == 1 || tsgs == 2))
+		gse_frame(bbf, fr);
+	if (!bbf->queue)
+		return;
+	__atomic_store_n(&bbf->wp, bbf->wp + 1, __ATOMIC_RELEASE);
+	bbf_signal(bbf->evfd);
+}
+
+/*
+ * Feed TS packets, packets of other PIDs are ignored. Returns the number
+ * of frames completed.
+ */
+LIBDDDVB_EXPORTED int dddvb_bbf_put(struct dddvb_bbf *bbf, const uint8_t **pkt, int n)
+{
+	struct dddvb_bbframe *fr;
+	uint64_t frames = bbf->frames;
+	const uint8_t *p;
+	uint32_t l;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		p = pkt[i];
+		if (p[0] != 0x47 || (((p[1] & 0x1f) << 8) | p[2]) != DDDVB_BBF_PID)
+			continue;
+		l = p[7];
+		if (p[5] != 0x80 || !l || l > 180) {
+			if (bbf->cnt >= 0)
+				bbf->seq_errors++;
+			bbf->cnt = -1;
+			continue;
+		}
+		if ((p[1] & 0x40) && p[8] == 0xb8) {
+			if (bbf->cnt >= 0)
+				bbf_done(bbf);
+			if (bbf->queue &&
+			    bbf->wp - __atomic_load_n(&bbf->rp, __ATOMIC_ACQUIRE) >=
+			    bbf->nframes) {
+				bbf->drops++;
+				continue;
+			}
+			fr = bbf_cur(bbf);
+			if (l < 11) {
+				bbf->seq_errors++;
+				continue;
+			}
+			memcpy(fr->data, p + 9, l - 1);
+			fr->len = l - 1;
+			if (bbf_header(bbf, fr) < 0) {
+				bbf->crc_errors++;
+				continue;
+			}
+			bbf->cnt = 0;
+		} else {
+			if (bbf->cnt < 0)
+				continue;
+			fr = bbf_cur(bbf);
+			if (p[8] != bbf->cnt + 1 ||
+			    fr->len + l - 1 > DDDVB_BBF_MAX) {
+				bbf->seq_errors++;
+				bbf->cnt = -1;
+				continue;
+			}
+			bbf->cnt++;
+			memcpy(fr->data + fr->len, p + 9, l - 1);
+			fr->len += l - 1;
+		}
+		if (l < 180)
+			bbf_done(bbf);
+	}
+	return bbf->frames - frames;
+}
+
+/*
+ * Allocate a reassembler with a ring of nframes frames (rounded up to a
+ * power of 2). With nframes 0 frames are not queued, only decapsulated.
+ */
+LIBDDDVB_EXPORTED struct dddvb_bbf *dddvb_bbf_alloc(uint32_t nframes)
+{
+	struct dddvb_bbf *bbf;
+
+	dddvb_crc_init();
+	bbf = calloc(1, sizeof(struct dddvb_bbf));
+	if (!bbf)
+		return NULL;
+	bbf->queue = nframes ? 1 : 0;
+	for (bbf->nframes = 1; bbf->nframes < nframes; bbf->nframes <<= 1)
+		;
+	bbf->cnt = -1;
+	bbf->tun_fd = -1;
+	bbf->frame = malloc(bbf->nframes * sizeof(struct dddvb_bbframe));
+	bbf->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (!bbf->frame || bbf->evfd < 0) {
+		if (bbf->evfd >= 0)
+			close(bbf->evfd);
+		free(bbf->frame);
+		free(bbf);
+		return NULL;
+	}
+	return bbf;
+}
+
+LIBDDDVB_EXPORTED void dddvb_bbf_free(struct dddvb_bbf *bbf)
+{
+	int i;
+
+	for (i = 0; i < DDDVB_GSE_FRAGS; i++)
+		free(bbf->frag[i].buf);
+	if (bbf->tun_fd >= 0)
+		close(bbf->tun_fd);
+	close(bbf->evfd);
+	free(bbf->frame);
+	free(bbf);
+}
+
+static void *bbf_reader(void *arg)
+{
+	struct dddvb_bbf *bbf = arg;
+	struct pollfd pfd = { .fd = dddvb_ts_sub_fd(bbf->sub), .events = POLLIN };
+	const uint8_t *pkt[256];
+	int n;
+
+	while (!bbf->exit) {
+		poll(&pfd, 1, 100);
+		n = dddvb_ts_sub_read(bbf->sub, pkt, 256);
+		if (n == -EOVERFLOW) {
+			if (bbf->cnt >= 0)
+				bbf->seq_errors++;
+			bbf->cnt = -1;
+			continue;
+		}
+		if (n <= 0)
+			continue;
+		dddvb_bbf_put(bbf, pkt, n);
+		dddvb_ts_sub_ack(bbf->sub, n);
+	}
+	return NULL;
+}
+
+/*
+ * Reassemble frames from a TS engine in a thread of its own. The demod
+ * has to be tuned with stream id 0x80000000 to output BBFrames. Close
+ * before the TS engine.
+ */
+LIBDDDVB_EXPORTED struct dddvb_bbf *dddvb_bbf_open(struct dddvb_ts *ts, uint32_t nframes)
+{
+	struct dddvb_bbf *bbf;
+
+	bbf = dddvb_bbf_alloc(nframes);
+	if (!bbf)
+		return NULL;
+	bbf->sub = dddvb_ts_subscribe(ts, 0);
+	if (!bbf->sub)
+		goto fail;
+	dddvb_ts_sub_pid(bbf->sub, DDDVB_BBF_PID, 1);
+	if (pthread_create(&bbf->pt, NULL, bbf_reader, bbf)) {
+		dddvb_ts_unsubscribe(bbf->sub);
+		goto fail;
+	}
+	return bbf;
+fail:
+	dddvb_bbf_free(bbf);
+	return NULL;
+}
+
+LIBDDDVB_EXPORTED void dddvb_bbf_close(struct dddvb_bbf *bbf)
+{
+	bbf->exit = 1;
+	pthread_join(bbf->pt, NULL);
+	dddvb_ts_unsubscribe(bbf->sub);
+	dddvb_bbf_free(bbf);
+}
+
+/* becomes readable when frames are queued */
+LIBDDDVB_EXPORTED int dddvb_bbf_fd(struct dddvb_bbf *bbf)
+{
+	return bbf->evfd;
+}
+
+/* oldest queued frame or NULL, valid until dddvb_bbf_release() */
+LIBDDDVB_EXPORTED const struct dddvb_bbframe *dddvb_bbf_get(struct dddvb_bbf *bbf)
+{
+	uint64_t val;
+
+	if (__atomic_load_n(&bbf->wp, __ATOMIC_ACQUIRE) == bbf->rp) {
+		/* clear the event before the second look */
+		if (read(bbf->evfd, &val, sizeof(val)) < 0 && errno != EAGAIN)
+			return NULL;
+		if (__atomic_load_n(&bbf->wp, __ATOMIC_ACQUIRE) == bbf->rp)
+			return NULL;
+	}
+	return &bbf->frame[bbf->rp & (bbf->nframes - 1)];
+}
+
+LIBDDDVB_EXPORTED void dddvb_bbf_release(struct dddvb_bbf *bbf)
+{
+	__atomic_store_n(&bbf->rp, bbf->rp + 1, __ATOMIC_RELEASE);
+}
+
+/* pass GSE PDUs to cb, has to be set before frames are fed */
+LIBDDDVB_EXPORTED int dddvb_bbf_gse(struct dddvb_bbf *bbf, dddvb_gse_cb cb, void *priv)
+{
+	int i;
+
+	for (i = 0; i < DDDVB_GSE_FRAGS; i++) {
+		if (bbf->frag[i].buf)
+			continue;
+		/* total length field, PDU and CRC32 */
+		bbf->frag[i].buf = malloc(DDDVB_GSE_MAX_PDU + 8);
+		if (!bbf->frag[i].buf)
+			return -ENOMEM;
+	}
+	bbf->gse_priv = priv;
+	bbf->gse_cb = cb;
+	return 0;
+}
+
+static int gse_tun_write(void *priv, uint16_t proto, const uint8_t *pdu, uint32_t len)
+{
+	struct dddvb_bbf *bbf = priv;
+
+	if (proto != 0x0800 && proto != 0x86dd)
+		return 0;
+	if (write(bbf->tun_fd, pdu, len) < 0)
+		return -errno;
+	return 0;
+}
+
+/* write IPv4/IPv6 PDUs to the TUN device name, created if needed */
+LIBDDDVB_EXPORTED int dddvb_bbf_gse_tun(struct dddvb_bbf *bbf, const char *name)
+{
+	struct ifreq ifr;
+	int fd;
+
+	fd = open("/dev/net/tun", O_RDWR | O_CLOEXEC);
+	if (fd < 0)
+		return -errno;
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+	strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+	if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+		close(fd);
+		return -errno;
+	}
+	dbgprintf(DEBUG_DVB, "bbf: GSE to %s\n", ifr.ifr_name);
+	if (bbf->tun_fd >= 0)
+		close(bbf->tun_fd);
+	bbf->tun_fd = fd;
+	return dddvb_bbf_gse(bbf, gse_tun_write, bbf);
+}
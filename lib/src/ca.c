@@ -20,18 +20,32 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <sys/un.h>
 #include <netdb.h>
 #include <net/if.h>
 #include <net/ethernet.h>
 #include <net/if_arp.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 
 #define MMI_STATE_CLOSED 0
 #define MMI_STATE_OPEN 1
 #define MMI_STATE_ENQ 2
 #define MMI_STATE_MENU 3
 
+/* event sources of the CA event loop, stored in the upper 32 bits of epoll data */
+#define CA_EV_WAKE   0
+#define CA_EV_TIMER  1
+#define CA_EV_LISTEN 2
+#define CA_EV_SOCK   3
+#define CA_EV_CAM    4
+
+/* EN50221 transport layer poll interval */
+#define CA_TICK_MS 100
+
 void dump(FILE *fp, uint8_t *b, int l)
 {
 	int i, j;
@@ -265,8 +279,10 @@ static int handle_pmts(struct dddvb_ca *ca)
 			return -1;
 		}
 	}
-	if (num)
+	if (num) {
 		ca->sentpmt = 1;
+		ca->poll_pending = 1;
+	}
 	return 0;
 }
 
@@ -342,8 +358,10 @@ static int set_pmts(struct dddvb_ca *ca, uint8_t **pmts)
 			return -1;
 		}
 	}
-	if (num)
+	if (num) {
 		ca->sentpmt = 1;
+		ca->poll_pending = 1;
+	}
 	return 0;
 }
 
@@ -397,7 +415,7 @@ static int proc_csock(struct dddvb_ca *ca)
 	int len, i, res;
 	
 	if (ca->stdcam == NULL)
-		return -1;
+		goto release;
 	while ((len = recv(ca->sock, buf, 1, 0)) >= 0) {
 		if (len == 0) 
 			goto release;
@@ -416,12 +434,27 @@ release:
 }
 
 
-static void handle_ci(struct dddvb_ca *ca)
+static int ca_ep_ctl(struct dddvb *dd, int op, int fd, uint32_t type, uint32_t nr)
 {
-	uint8_t sec[4096];
-	uint32_t pmt_count, tdt_count;
-	int len;
-	int sock, i;
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = ((uint64_t) type << 32) | nr;
+	return epoll_ctl(dd->ca_epfd, op, fd, &ev);
+}
+
+static void ca_wake(struct dddvb *dd)
+{
+	uint64_t one = 1;
+
+	if (dd->ca_evfd >= 0)
+		write(dd->ca_evfd, &one, sizeof(one));
+}
+
+static int ca_listen(struct dddvb_ca *ca)
+{
+	int sock;
 	struct sockaddr sadr;
 	char port[6], path[32];
 
@@ -434,82 +467,153 @@ static void handle_ci(struct dddvb_ca *ca)
 	} else {
 		sock = -1;
 	}
+	if (sock < 0)
+		return -1;
 	if (listen(sock, 4) < 0) {
 		dbgprintf(DEBUG_CA, "listen error");
+		close(sock);
+		return -1;
+	}
+	return sock;
+}
+
+static void ca_accept(struct dddvb_ca *ca)
+{
+	struct sockaddr cadr;
+	socklen_t len = sizeof(cadr);
+
+	ca->sock = accept(ca->lsock, &cadr, &len);
+	if (ca->sock < 0)
 		return;
+	set_nonblock(ca->sock);
+	/* one client per slot, further connections wait in the backlog */
+	ca_ep_ctl(ca->dd, EPOLL_CTL_DEL, ca->lsock, CA_EV_LISTEN, ca->nr - 1);
+	ca_ep_ctl(ca->dd, EPOLL_CTL_ADD, ca->sock, CA_EV_SOCK, ca->nr - 1);
+}
+
+static void ca_update_pmt(struct dddvb_ca *ca)
+{
+	int i;
+
+	pthread_mutex_lock(&ca->mutex);
+	if (ca->state && ca->setpmt) {
+		dbgprintf(DEBUG_CA, "got new PMT %08x\n", ca->pmt_new[0]);
+		memcpy(ca->pmt, ca->pmt_new, sizeof(ca->pmt));
+		memset(ca->pmt_old, 0, sizeof(ca->pmt_old));
+		for (i = 0; i < MAX_PMT; i++)
+			ca->ca_pmt_version[i] = -1;
+		ca->sentpmt = 0;
+		ca->setpmt = 0;
+		ca->poll_pending = 1;
 	}
-	ca->sock = -1;
-	
-	while (1) {//!ca->exit) {
-		struct timeval timeout;
-		uint32_t count = 0;
-		int num;
-		int mfd;
-		fd_set fds;
-		
-		timeout.tv_sec = 0;
-		timeout.tv_usec = 200000;
-		FD_ZERO(&fds);
-		if (ca->sock < 0) { 
-			FD_SET(sock, &fds);
-			num = select(sock + 1, &fds, NULL, NULL, &timeout);
-		} else {
-			FD_SET(ca->sock, &fds);
-			num = select(ca->sock + 1, &fds, NULL, NULL, &timeout);
-		}
-		if (num > 0) {
-			if (ca->sock < 0) {
-				if (FD_ISSET(sock, &fds)) {
-					socklen_t len;
-					struct sockaddr cadr;
-					
-					ca->sock = accept(sock, &cadr, &len);
-					if (ca->sock >= 0) {
-						set_nonblock(ca->sock);
-					}
-				}
-			} else {
-				if (FD_ISSET(ca->sock, &fds)) {
-					proc_csock(ca);
-				}
-			}
-		}
-		
-		pthread_mutex_lock(&ca->mutex);
-		if (!ca->state) {
-			pthread_mutex_unlock(&ca->mutex);
-			continue;
-		}
-		if (ca->setpmt) {
-			dbgprintf(DEBUG_CA, "got new PMT %08x\n", ca->pmt_new); 
-			memcpy(ca->pmt, ca->pmt_new, sizeof(ca->pmt));
-			memset(ca->pmt_old, 0, sizeof(ca->pmt_old));
-			for (i = 0; i < MAX_PMT; i++)
-				ca->ca_pmt_version[i] = -1;
-			ca->sentpmt = 0;
-			ca->setpmt = 0;
-			pmt_count = 0;
-			tdt_count = 0;
+	pthread_mutex_unlock(&ca->mutex);
+}
+
+static uint64_t ca_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void ca_poll(struct dddvb_ca *ca)
+{
+	ca->poll_pending = 0;
+	if (!ca->stdcam)
+		return;
+	ca->last_poll = ca_now_ms();
+	ca->stdcam->poll(ca->stdcam);
+}
+
+/*
+ * One thread serves all CA slots: CAM I/O, the MMI control sockets and
+ * PMT updates signalled through an eventfd. A slot is polled when its CA
+ * device is readable or a CA PMT/MMI answer is queued for it. The timerfd
+ * only polls slots which have been idle for CA_TICK_MS, so the transport
+ * layer keeps its T_DATA_LAST polling and sees CAM insertion/removal.
+ */
+static void handle_cas(struct dddvb *dd)
+{
+	struct epoll_event evs[32];
+	struct dddvb_ca *ca;
+	uint64_t val, now;
+	uint32_t nr;
+	int i, j, num;
+
+	while (!dd->exit) {
+		num = epoll_wait(dd->ca_epfd, evs, 32, -1);
+		if (num < 0) {
+			if (errno == EINTR)
+				continue;
+			dbgprintf(DEBUG_CA, "epoll_wait error %d\n", errno);
+			break;
 		}
-		pthread_mutex_unlock(&ca->mutex);
-
-		/*
-		  if (!ca->sentpmt)
-		    handle_pmts(ca);
-		else {
-			pmt_count++;
-			if (pmt_count == 10) {
-				//handle_pmts(ca);
-				pmt_count = 0;
+		for (i = 0; i < num; i++) {
+			nr = evs[i].data.u64 & 0xffffffff;
+			ca = &dd->dvbca[nr];
+			switch (evs[i].data.u64 >> 32) {
+			case CA_EV_WAKE:
+				read(dd->ca_evfd, &val, sizeof(val));
+				for (j = 0; j < dd->dvbca_num; j++)
+					ca_update_pmt(&dd->dvbca[j]);
+				break;
+			case CA_EV_TIMER:
+				read(dd->ca_tfd, &val, sizeof(val));
+				now = ca_now_ms();
+				for (j = 0; j < dd->dvbca_num; j++)
+					if (now - dd->dvbca[j].last_poll >= CA_TICK_MS)
+						dd->dvbca[j].poll_pending = 1;
+				break;
+			case CA_EV_LISTEN:
+				if (ca->sock < 0)
+					ca_accept(ca);
+				break;
+			case CA_EV_SOCK:
+				if (ca->sock >= 0 && proc_csock(ca) < 0)
+					ca_ep_ctl(dd, EPOLL_CTL_ADD, ca->lsock,
+						  CA_EV_LISTEN, nr);
+				/* MMI answers are only sent out by the next poll */
+				ca->poll_pending = 1;
+				break;
+			case CA_EV_CAM:
+				ca_poll(ca);
+				break;
 			}
 		}
-		*/
-		tdt_count++;
-		if (tdt_count == 10) {
-			//handle_tdt(ca);
-			tdt_count = 0;
-		}
+		for (j = 0; j < dd->dvbca_num; j++)
+			if (dd->dvbca[j].poll_pending)
+				ca_poll(&dd->dvbca[j]);
+	}
+}
+
+static int ca_loop_start(struct dddvb *dd)
+{
+	struct itimerspec its = {
+		.it_interval = { 0, CA_TICK_MS * 1000000 },
+		.it_value = { 0, CA_TICK_MS * 1000000 },
+	};
+	struct dddvb_ca *ca;
+	int i;
+
+	dd->ca_epfd = epoll_create1(EPOLL_CLOEXEC);
+	dd->ca_evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	dd->ca_tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (dd->ca_epfd < 0 || dd->ca_evfd < 0 || dd->ca_tfd < 0) {
+		dbgprintf(DEBUG_CA, "Failed to create CA event loop\n");
+		return -1;
+	}
+	timerfd_settime(dd->ca_tfd, 0, &its, NULL);
+	ca_ep_ctl(dd, EPOLL_CTL_ADD, dd->ca_evfd, CA_EV_WAKE, 0);
+	ca_ep_ctl(dd, EPOLL_CTL_ADD, dd->ca_tfd, CA_EV_TIMER, 0);
+	for (i = 0; i < dd->dvbca_num; i++) {
+		ca = &dd->dvbca[i];
+		if (ca->lsock >= 0)
+			ca_ep_ctl(dd, EPOLL_CTL_ADD, ca->lsock, CA_EV_LISTEN, i);
+		if (ca->stdcam)
+			ca_ep_ctl(dd, EPOLL_CTL_ADD, ca->fd, CA_EV_CAM, i);
 	}
+	return pthread_create(&dd->ca_pt, NULL, (void *) handle_cas, dd);
 }
 
 
@@ -520,19 +624,11 @@ int set_pmt(struct dddvb_ca *ca, uint32_t *pmt)
 	ca->setpmt = 1;
 	memcpy(ca->pmt_new, pmt, sizeof(ca->pmt_new));
 	pthread_mutex_unlock(&ca->mutex);
+	ca_wake(ca->dd);
 	return 0;
 }
 
 
-static void ci_poll(struct dddvb_ca *ca)
-{
-	while (!ca->dd->exit) {
-		ca->stdcam->poll(ca->stdcam);
-		
-	}
-}
-
-
 static int mmi_close_callback(void *arg, uint8_t slot_id, uint16_t snum,
 			      uint8_t cmd_id, uint8_t delay)
 {
@@ -694,10 +790,13 @@ static int init_ca(struct dddvb *dd, int a, int f, int fd)
 
 	//cam_reset(fd);
 	
-	init_ca_stack(ca);
-
-	pthread_create(&ca->poll_pt, NULL, (void *) ci_poll, ca); 
-	pthread_create(&ca->pt, NULL, (void *) handle_ci, ca); 
+	ca->sock = -1;
+	ca->lsock = -1;
+	/* the MMI socket is served by the stack, no stack no clients */
+	if (init_ca_stack(ca) < 0)
+		ca->stdcam = NULL;
+	else
+		ca->lsock = ca_listen(ca);
 	dvbf_init_pid(&ca->dvbf_tdt, 0x14);
 
 	sprintf(fname, "/dev/dvb/adapter%d/ci%d", a, f); 
@@ -730,30 +829,293 @@ int dddvb_ca_read(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len)
 	return read(ca->ci_rfd, buf, len);
 }
 
+/*
+ * Streaming CI interface:
+ * The caller fills strm_in, a writer thread feeds it to the ci device,
+ * a reader thread drains the ci device into strm_out. The CAM pipeline
+ * stays filled instead of being emptied after every write.
+ * dddvb_ca_stream_start() returns an fd which becomes readable when
+ * descrambled data is available.
+ */
+
+#define CA_RING_PACKETS  (2048)
+
+static int ring_init(struct dddvb_ca_ring *r)
+{
+	r->size = CA_RING_PACKETS * 188;
+	r->wp = r->rp = 0;
+	r->buf = malloc(r->size);
+	r->data_ev = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	r->space_ev = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (!r->buf || r->data_ev < 0 || r->space_ev < 0)
+		return -1;
+	return 0;
+}
+
+static void ring_free(struct dddvb_ca_ring *r)
+{
+	if (r->data_ev >= 0)
+		close(r->data_ev);
+	if (r->space_ev >= 0)
+		close(r->space_ev);
+	free(r->buf);
+	r->buf = NULL;
+	r->data_ev = r->space_ev = -1;
+}
+
+static void ev_signal(int fd)
+{
+	uint64_t one = 1;
+
+	if (write(fd, &one, sizeof(one)) < 0)
+		return;
+}
+
+static void ev_clear(int fd)
+{
+	uint64_t val;
+
+	if (read(fd, &val, sizeof(val)) < 0)
+		return;
+}
+
+/* contiguous bytes which can be read from the ring */
+static uint32_t ring_rspan(struct dddvb_ca_ring *r)
+{
+	uint32_t wp = __atomic_load_n(&r->wp, __ATOMIC_ACQUIRE);
+
+	if (wp >= r->rp)
+		return wp - r->rp;
+	return r->size - r->rp;
+}
+
+/* contiguous bytes which can be written, one byte is kept free */
+static uint32_t ring_wspan(struct dddvb_ca_ring *r)
+{
+	uint32_t rp = __atomic_load_n(&r->rp, __ATOMIC_ACQUIRE);
+	uint32_t free = (rp + r->size - r->wp - 1) % r->size;
+
+	if (free > r->size - r->wp)
+		free = r->size - r->wp;
+	return free;
+}
+
+static void ring_rskip(struct dddvb_ca_ring *r, uint32_t len)
+{
+	uint32_t rp = r->rp + len;
+
+	if (rp >= r->size)
+		rp -= r->size;
+	__atomic_store_n(&r->rp, rp, __ATOMIC_RELEASE);
+	ev_signal(r->space_ev);
+}
+
+static void ring_wskip(struct dddvb_ca_ring *r, uint32_t len)
+{
+	uint32_t wp = r->wp + len;
+
+	if (wp >= r->size)
+		wp -= r->size;
+	__atomic_store_n(&r->wp, wp, __ATOMIC_RELEASE);
+	ev_signal(r->data_ev);
+}
+
+static int ev_wait(int fd, int timeout)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+
+	return poll(&pfd, 1, timeout);
+}
+
+static void *ca_stream_writer(void *arg)
+{
+	struct dddvb_ca *ca = arg;
+	struct dddvb_ca_ring *r = &ca->strm_in;
+	uint32_t len;
+	ssize_t res;
+
+	while (__atomic_load_n(&ca->strm_run, __ATOMIC_ACQUIRE)) {
+		len = ring_rspan(r);
+		if (!len) {
+			if (ev_wait(r->data_ev, 100) > 0)
+				ev_clear(r->data_ev);
+			continue;
+		}
+		res = write(ca->ci_wfd, r->buf + r->rp, len);
+		if (res < 0) {
+			if (errno != EINTR && errno != EAGAIN)
+				usleep(10000);
+			continue;
+		}
+		ring_rskip(r, res);
+	}
+	return NULL;
+}
+
+static void *ca_stream_reader(void *arg)
+{
+	struct dddvb_ca *ca = arg;
+	struct dddvb_ca_ring *r = &ca->strm_out;
+	uint32_t len;
+	ssize_t res;
+
+	while (__atomic_load_n(&ca->strm_run, __ATOMIC_ACQUIRE)) {
+		len = ring_wspan(r);
+		if (len < 188) {
+			if (ev_wait(r->space_ev, 100) > 0)
+				ev_clear(r->space_ev);
+			continue;
+		}
+		if (ev_wait(ca->ci_rfd, 100) <= 0)
+			continue;
+		res = read(ca->ci_rfd, r->buf + r->wp, len - len % 188);
+		if (res <= 0)
+			continue;
+		ring_wskip(r, res);
+	}
+	return NULL;
+}
+
+int dddvb_ca_stream_start(struct dddvb *dd, uint32_t nr)
+{
+	struct dddvb_ca *ca = &dd->dvbca[nr];
+
+	if (ca->strm_run)
+		return ca->strm_out.data_ev;
+	if (ca->ci_wfd < 0 || ca->ci_rfd < 0)
+		return -ENODEV;
+	ca->strm_in.data_ev = ca->strm_in.space_ev = -1;
+	ca->strm_out.data_ev = ca->strm_out.space_ev = -1;
+	ca->strm_in.buf = ca->strm_out.buf = NULL;
+	if (ring_init(&ca->strm_in) < 0 || ring_init(&ca->strm_out) < 0)
+		goto fail;
+	ca->strm_run = 1;
+	if (pthread_create(&ca->strm_wpt, NULL, ca_stream_writer, ca))
+		goto fail;
+	if (pthread_create(&ca->strm_rpt, NULL, ca_stream_reader, ca)) {
+		__atomic_store_n(&ca->strm_run, 0, __ATOMIC_RELEASE);
+		pthread_join(ca->strm_wpt, NULL);
+		goto fail;
+	}
+	return ca->strm_out.data_ev;
+fail:
+	ca->strm_run = 0;
+	ring_free(&ca->strm_in);
+	ring_free(&ca->strm_out);
+	return -ENOMEM;
+}
+
+void dddvb_ca_stream_stop(struct dddvb *dd, uint32_t nr)
+{
+	struct dddvb_ca *ca = &dd->dvbca[nr];
+
+	if (!ca->strm_run)
+		return;
+	__atomic_store_n(&ca->strm_run, 0, __ATOMIC_RELEASE);
+	ev_signal(ca->strm_in.data_ev);
+	ev_signal(ca->strm_out.space_ev);
+	pthread_join(ca->strm_wpt, NULL);
+	pthread_join(ca->strm_rpt, NULL);
+	ring_free(&ca->strm_in);
+	ring_free(&ca->strm_out);
+}
+
+/* queue TS packets for the CAM, returns the number of bytes accepted */
+int dddvb_ca_stream_write(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len)
+{
+	struct dddvb_ca *ca = &dd->dvbca[nr];
+	struct dddvb_ca_ring *r = &ca->strm_in;
+	uint32_t i, n, done = 0;
+
+	if (len % 188)
+		return -EINVAL;
+	if (!ca->strm_run)
+		return -EBADF;
+	ev_clear(r->space_ev);
+	while (done < len) {
+		n = ring_wspan(r);
+		if (n < 188)
+			break;
+		if (n > len - done)
+			n = len - done;
+		n -= n % 188;
+		for (i = 0; i < n; i += 188)
+			if (proc_pidf(&ca->dvbf_tdt, buf + done + i) > 0)
+				handle_tdt(ca);
+		memcpy(r->buf + r->wp, buf + done, n);
+		ring_wskip(r, n);
+		done += n;
+	}
+	return done;
+}
+
+/* fetch descrambled TS packets, returns 0 if none are available */
+int dddvb_ca_stream_read(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len)
+{
+	struct dddvb_ca *ca = &dd->dvbca[nr];
+	struct dddvb_ca_ring *r = &ca->strm_out;
+	uint32_t n, done = 0;
+
+	if (!ca->strm_run)
+		return -EBADF;
+	ev_clear(r->data_ev);
+	len -= len % 188;
+	while (done < len) {
+		n = ring_rspan(r);
+		if (!n)
+			break;
+		if (n > len - done)
+			n = len - done;
+		memcpy(buf + done, r->buf + r->rp, n);
+		ring_rskip(r, n);
+		done += n;
+	}
+	return done;
+}
+
 int dddvb_ca_set_pmts(struct dddvb *dd, uint32_t nr, uint8_t **pmts)
 {
 	struct dddvb_ca *ca = &dd->dvbca[nr];
 
+	int ret;
+
 	dbgprintf(DEBUG_CA, "ca%u.%u.%u:ca_set_pmt\n", ca->nr,ca->anum,ca->fnum);
-	return set_pmts(ca, pmts);
+	ret = set_pmts(ca, pmts);
+	if (!ret)
+		ca_wake(dd);
+	return ret;
 }
 
 
-int scan_dvbca(struct dddvb *dd)
+static void add_ca(struct dddvb *dd, int a, int f)
 {
-	int a, f, fd;
 	char fname[80];
+	int fd;
 
-	for (a = 0; a < 16; a++) {
-		for (f = 0; f < 16; f++) {
-			sprintf(fname, "/dev/dvb/adapter%d/ca%d", a, f); 
-			fd = open(fname, O_RDWR);
-			if (fd >= 0) {
-				init_ca(dd, a, f, fd);
-				//close(fd);
-			}
-		}
+	sprintf(fname, "/dev/dvb/adapter%d/ca%d", a, f);
+	fd = open(fname, O_RDWR);
+	if (fd >= 0)
+		init_ca(dd, a, f, fd);
+}
+
+int scan_dvbca(struct dddvb *dd)
+{
+	uint32_t ids[DDDVB_MAX_DVB_CA];
+	int a, f, i, n;
+
+	dd->ca_epfd = dd->ca_evfd = dd->ca_tfd = -1;
+	n = dvb_sysfs_scan("ca", ids, DDDVB_MAX_DVB_CA);
+	if (n >= 0) {
+		for (i = 0; i < n; i++)
+			add_ca(dd, ids[i] >> 8, ids[i] & 0xff);
+	} else {
+		for (a = 0; a < 16; a++)
+			for (f = 0; f < 16; f++)
+				add_ca(dd, a, f);
 	}
 	dbgprintf(DEBUG_CA, "Found %d CA interfaces\n", dd->dvbca_num);
+	if (dd->dvbca_num)
+		ca_loop_start(dd);
+	return 0;
 }
 
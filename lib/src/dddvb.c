@@ -20,16 +20,20 @@ LIBDDDVB_EXPORTED struct dddvb_fe *dddvb_fe_alloc_num(struct dddvb *dd, uint32_t
 	dbgprintf(DEBUG_SYS, "alloc_fe_num %u type %u\n", num, type);
 	pthread_mutex_lock(&dd->lock);
 	fe = &dd->dvbfe[num];
-	if (fe->state || !(fe->type & (1UL << type))) {
+	if (fe->state || fe->removed || !(fe->type & (1UL << type))) {
 		dbgprintf(DEBUG_SYS, "fe %d  state = %d, type = %08x wanted %08x\n",
 			  fe->nr, fe->state, fe->type, 1UL << type);
 		pthread_mutex_unlock(&dd->lock);
 		return NULL;
 	}
 	fe->state = 1;
+	fe->users = 1;
+	fe->shared = 0;
 	pthread_mutex_unlock(&dd->lock);
 	if (dddvb_fe_start(fe) < 0) {
 		dbgprintf(DEBUG_SYS, "fe %d busy\n", fe->nr);
+		fe->users = 0;
+		fe->state = 0;
 		return NULL;
 	}
 	dbgprintf(DEBUG_SYS, "Allocated fe %d = %d/%d, fd=%d\n",
@@ -61,11 +65,156 @@ LIBDDDVB_EXPORTED struct dddvb_fe *dddvb_fe_alloc(struct dddvb *dd, uint32_t typ
 	return fe;
 }
 
+/* parameters which select a transponder, others do not prevent sharing */
+static const int tune_param[] = {
+	PARAM_MSYS, PARAM_FREQ, PARAM_SRC, PARAM_POL, PARAM_SR,
+	PARAM_BW_HZ, PARAM_ISI, PARAM_SSI,
+};
+
+static int same_transponder(struct dddvb_fe *fe, struct dddvb_params *p)
+{
+	int i, same = 1;
+
+	pthread_mutex_lock(&fe->mutex);
+	for (i = 0; i < sizeof(tune_param) / sizeof(tune_param[0]); i++)
+		if (fe->n_param.param[tune_param[i]] != p->param[tune_param[i]])
+			same = 0;
+	pthread_mutex_unlock(&fe->mutex);
+	return same;
+}
+
+static int is_sat(uint32_t msys)
+{
+	return msys == SYS_DVBS || msys == SYS_DVBS2 || msys == SYS_ISDBS;
+}
+
+/* LNB selection of a satellite tune: source, polarisation and band */
+static uint32_t sat_band(struct dddvb_fe *fe, struct dddvb_params *p)
+{
+	uint32_t src = p->param[PARAM_SRC], lofs, hi = 0;
+
+	if (src == DDDVB_UNDEF)
+		src = 0;
+	lofs = fe->lofs[src & (DDDVB_MAX_SOURCE - 1)];
+	if (lofs && p->param[PARAM_FREQ] > lofs)
+		hi = 1;
+	return (src << 2) | ((p->param[PARAM_POL] & 1) << 1) | hi;
+}
+
+/*
+ * Cost of tuning an idle frontend to p. Unicable frontends only
+ * contend for their SCR slot. Other frontends on the same adapter share
+ * the LNB inputs, which is cheap if they already use the same band and
+ * expensive if they hold a different one.
+ */
+static int fe_cost(struct dddvb *dd, struct dddvb_fe *fe, struct dddvb_params *p)
+{
+	struct dddvb_fe *ofe;
+	uint32_t band;
+	int i, cost = 0;
+
+	if (!is_sat(p->param[PARAM_MSYS]))
+		return 0;
+	band = sat_band(fe, p);
+	for (i = 0; i < dd->dvbfe_num; i++) {
+		ofe = &dd->dvbfe[i];
+		if (ofe == fe || ofe->state != 1 || !is_sat(ofe->n_param.param[PARAM_MSYS]))
+			continue;
+		if (fe->scif_type == 1 || fe->scif_type == 2) {
+			if (ofe->scif_type == fe->scif_type && ofe->scif_slot == fe->scif_slot)
+				cost += 4;
+			continue;
+		}
+		if (ofe->anum != fe->anum || ofe->scif_type == 1 || ofe->scif_type == 2)
+			continue;
+		if (sat_band(ofe, &ofe->n_param) == band)
+			cost -= 1;
+		else
+			cost += 2;
+	}
+	return cost;
+}
+
+/*
+ * Allocate a frontend for the transponder in p and tune it.
+ * A frontend allocated here and already tuned to the same transponder
+ * is shared and its use count increased. Shared frontends can not be
+ * retuned with dddvb_dvb_tune(). Release with dddvb_fe_release().
+ */
+LIBDDDVB_EXPORTED struct dddvb_fe *dddvb_fe_alloc_tune(struct dddvb *dd, struct dddvb_params *p)
+{
+	struct dddvb_fe *fe = NULL, *tfe;
+	uint32_t type = p->param[PARAM_MSYS];
+	int i, cost, best = 0;
+
+	if (type >= 32)
+		return NULL;
+	pthread_mutex_lock(&dd->lock);
+	for (i = 0; i < dd->dvbfe_num; i++) {
+		tfe = &dd->dvbfe[i];
+		if (tfe->state == 1 && tfe->users && tfe->shared && !tfe->removed &&
+		    same_transponder(tfe, p)) {
+			tfe->users++;
+			pthread_mutex_unlock(&dd->lock);
+			dbgprintf(DEBUG_SYS, "alloc_fe_tune share fe %d, users %u\n",
+				  tfe->nr, tfe->users);
+			return tfe;
+		}
+	}
+	for (i = 0; i < dd->dvbfe_num; i++) {
+		tfe = &dd->dvbfe[i];
+		if (tfe->state || tfe->removed || !(tfe->type & (1UL << type)))
+			continue;
+		cost = fe_cost(dd, tfe, p);
+		if (!fe || cost < best) {
+			fe = tfe;
+			best = cost;
+		}
+	}
+	if (fe)
+		fe = dddvb_fe_alloc_num(dd, type, fe->nr);
+	if (fe) {
+		fe->shared = 1;
+		/* make the transponder visible to other clients right away */
+		pthread_mutex_lock(&fe->mutex);
+		memcpy(fe->n_param.param, p->param, sizeof(fe->n_param.param));
+		pthread_mutex_unlock(&fe->mutex);
+	}
+	pthread_mutex_unlock(&dd->lock);
+	if (!fe) {
+		dbgprintf(DEBUG_SYS, "alloc_fe_tune type %u failed!\n", type);
+		return NULL;
+	}
+	dbgprintf(DEBUG_SYS, "alloc_fe_tune fe %d, cost %d\n", fe->nr, best);
+	dddvb_fe_do_tune(fe, p);
+	return fe;
+}
+
+LIBDDDVB_EXPORTED void dddvb_fe_release(struct dddvb_fe *fe)
+{
+	struct dddvb *dd = fe->dd;
+
+	pthread_mutex_lock(&dd->lock);
+	if (!fe->users || --fe->users) {
+		pthread_mutex_unlock(&dd->lock);
+		return;
+	}
+	fe->state = 2;
+	pthread_mutex_unlock(&dd->lock);
+	pthread_join(fe->pt, NULL);
+	dbgprintf(DEBUG_SYS, "released fe %d\n", fe->nr);
+}
+
 LIBDDDVB_EXPORTED int dddvb_dvb_tune(struct dddvb_fe *fe, struct dddvb_params *p)
 {
 	return dddvb_fe_tune(fe, p);
 }
 
+LIBDDDVB_EXPORTED int dddvb_rescan(struct dddvb *dd)
+{
+	return dddvb_dvb_rescan(dd);
+}
+
 LIBDDDVB_EXPORTED struct dddvb *dddvb_init(char *config, uint32_t flags)
 {
 	struct dddvb *dd;
@@ -92,6 +241,7 @@ LIBDDDVB_EXPORTED struct dddvb *dddvb_init(char *config, uint32_t flags)
 	
 	dd->get_ts = (flags & 0x100) ? 0 : 1;
 	dd->use_ca = (flags & 0x200) ? 0 : 1;
+	dd->hotplug = (flags & 0x400) ? 0 : 1;
 
 	dddvb_dvb_init(dd);
 	global_dd = dd;
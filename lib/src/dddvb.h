@@ -42,6 +42,9 @@ struct dddvb_status {
 struct dddvb_fe {
 	struct dddvb *dd;
 	uint32_t state;
+	uint32_t users;
+	uint32_t shared;      /* allocated by dddvb_fe_alloc_tune() */
+	uint32_t removed;     /* device is gone, entry kept for its number */
 	pthread_t pt;
 	pthread_mutex_t mutex;
 	char name[120];
@@ -107,6 +110,16 @@ struct dvbf_pid {
 	void *cbd;
 };
 
+/* single producer/single consumer ring of TS packets */
+struct dddvb_ca_ring {
+	uint8_t *buf;
+	uint32_t size;
+	uint32_t wp;
+	uint32_t rp;
+	int data_ev;
+	int space_ev;
+};
+
 struct dddvb_ca {
 	struct dddvb *dd;
 	struct osstrm *stream;
@@ -120,9 +133,6 @@ struct dddvb_ca {
 	int nr;
 	int input;
 
-	pthread_t pt;
-	pthread_t poll_pt;
-
 	pthread_mutex_t mutex;
 
 	struct en50221_transport_layer *tl;
@@ -135,6 +145,8 @@ struct dddvb_ca {
 	int data_pmt_version;
 
 	int setpmt;
+	int poll_pending;
+	uint64_t last_poll;
 	uint32_t pmt[MAX_PMT];
 	uint32_t pmt_new[MAX_PMT];
 	uint32_t pmt_old[MAX_PMT];
@@ -142,11 +154,197 @@ struct dddvb_ca {
 	int mmi_state;
 	uint8_t mmi_buf[16];
 	int mmi_bufp;
+	int lsock;
 	int sock;
 
 	struct dvbf_pid dvbf_tdt;
+
+	int strm_run;
+	pthread_t strm_wpt;
+	pthread_t strm_rpt;
+	struct dddvb_ca_ring strm_in;
+	struct dddvb_ca_ring strm_out;
 };
 	
+#define DDDVB_TS_MAX_SUB    64
+#define DDDVB_TS_PACKETS    16384
+#define DDDVB_TS_SUB_QUEUE  8192
+
+/* subscriber flags */
+#define DDDVB_TS_SUB_BLOCK  1  /* never drop, stall the reader instead */
+
+struct dddvb_ts;
+
+struct dddvb_ts_sub {
+	struct dddvb_ts *ts;
+	int id;
+	uint32_t flags;
+	int evfd;
+
+	/* sequence numbers of packets in the shared ring */
+	uint32_t *q;
+	uint32_t qsize;
+	uint32_t wp;
+	uint32_t rp;
+
+	int overflow;
+	uint64_t drops;
+};
+
+struct dddvb_ts {
+	int fd;
+	int own_fd;
+	int exit;
+	pthread_t pt;
+	pthread_mutex_t lock;
+	pthread_cond_t space;   /* signalled when subscribers free ring space */
+	int space_wait;
+
+	uint8_t *buf;
+	uint32_t npkt;
+	uint32_t seq;
+
+	uint64_t active;
+	uint64_t pidmask[8192];
+	struct dddvb_ts_sub *sub[DDDVB_TS_MAX_SUB];
+};
+
+/* spectrum scan, see scan.c; frequencies in kHz */
+struct dddvb_scan_params {
+	uint32_t freq_start;
+	uint32_t freq_end;
+	uint32_t pol;
+	uint32_t src;
+
+	uint32_t fft_size;    /* power of 2, default 1024 */
+	uint32_t averages;    /* spectra averaged per step, default 16 */
+	uint32_t threshold;   /* detection level above noise in 0.1 dB, default 60 */
+	uint32_t min_sr;      /* smallest symbol rate reported in Hz */
+	uint32_t confirm_ms;  /* lock wait per carrier, 0 = do not tune */
+
+	/* stitched spectrum in 0.1 dB, allocated if get_spectrum is set,
+	 * the caller frees it
+	 */
+	uint32_t get_spectrum;
+	int16_t *spectrum;
+	uint32_t spectrum_len;
+	uint32_t spectrum_step;  /* Hz per entry */
+};
+
+struct dddvb_carrier {
+	uint32_t freq;
+	uint32_t sr;
+	int32_t level;        /* 0.1 dB above noise */
+	uint32_t lock;
+};
+
+/* BBFrames embedded in TS, see docs/bbframes and bbf.c */
+#define DDDVB_BBF_PID       0x010e
+#define DDDVB_BBF_MAX       8192    /* BBHeader + largest data field */
+#define DDDVB_BBF_FRAMES    64
+#define DDDVB_GSE_FRAGS     8
+#define DDDVB_GSE_MAX_PDU   65536
+
+struct dddvb_bbframe {
+	uint8_t matype1;
+	uint8_t isi;          /* MATYPE2 */
+	uint16_t upl;
+	uint16_t dfl;         /* data field length in bits */
+	uint8_t sync;
+	uint16_t syncd;
+	uint8_t hem;          /* CRC8 was XORed with the HEM mode bit */
+	uint32_t len;         /* bytes in data, including the BBHeader */
+	uint8_t data[DDDVB_BBF_MAX];
+};
+
+struct dddvb_gse_frag {
+	uint32_t key;         /* ISI << 8 | fragment id */
+	uint32_t used;
+	uint32_t age;
+	uint32_t lt;          /* label type of the first fragment */
+	uint32_t len;
+	uint32_t total;
+	uint8_t *buf;
+};
+
+typedef int (*dddvb_gse_cb)(void *priv, uint16_t proto, const uint8_t *pdu, uint32_t len);
+
+struct dddvb_bbf {
+	/* single producer/single consumer ring of frames */
+	struct dddvb_bbframe *frame;
+	uint32_t nframes;
+	uint32_t queue;       /* 0: frames are only decapsulated */
+	uint32_t wp;
+	uint32_t rp;
+	int evfd;
+
+	/* packet counter of the frame being assembled, -1 while waiting
+	 * for a header packet
+	 */
+	int cnt;
+
+	dddvb_gse_cb gse_cb;
+	void *gse_priv;
+	uint32_t gse_age;
+	struct dddvb_gse_frag frag[DDDVB_GSE_FRAGS];
+	int tun_fd;
+
+	struct dddvb_ts_sub *sub;
+	pthread_t pt;
+	int exit;
+
+	uint64_t frames;
+	uint64_t crc_errors;
+	uint64_t seq_errors;
+	uint64_t drops;
+	uint64_t gse_pdus;
+	uint64_t gse_errors;
+};
+
+/* MIS/T2-MI splitter, see split.c */
+#define DDDVB_SPLIT_STREAMS 32
+#define DDDVB_SPLIT_OUTS    32
+#define DDDVB_SPLIT_BATCH   64
+#define DDDVB_T2MI_MAX      16384
+
+typedef int (*dddvb_split_cb)(void *priv, const uint8_t *ts, uint32_t npkt);
+
+/* user packet reassembly state of one ISI or PLP */
+struct dddvb_split_stream {
+	uint32_t id;
+	uint32_t plen;
+	uint8_t part[192];
+};
+
+struct dddvb_split_out {
+	int stream;           /* index into stream[] */
+	int fd;
+	dddvb_split_cb cb;
+	void *priv;
+	uint8_t pidmap[1024];
+	uint32_t n;
+	uint8_t buf[DDDVB_SPLIT_BATCH * 188];
+	uint64_t packets;
+};
+
+struct dddvb_split {
+	uint32_t nstreams;
+	struct dddvb_split_stream stream[DDDVB_SPLIT_STREAMS];
+	uint32_t nouts;
+	struct dddvb_split_out out[DDDVB_SPLIT_OUTS];
+
+	/* T2-MI packets carried in TS */
+	uint32_t t2mi_pid;
+	int t2mi_cc;
+	int t2mi_sync;        /* a packet start was seen since the last error */
+	uint32_t t2mi_len;
+	uint8_t t2mi_buf[DDDVB_T2MI_MAX];
+
+	uint64_t frames;
+	uint64_t t2mi_errors;
+	uint64_t sync_errors;
+};
+
 struct dddvb {
 	pthread_mutex_t lock;
 	pthread_mutex_t uni_lock;
@@ -167,6 +365,14 @@ struct dddvb {
 
 	uint32_t dvbca_num;
 	int exit;
+
+	pthread_t ca_pt;
+	int ca_epfd;
+	int ca_evfd;
+	int ca_tfd;
+
+	pthread_t hotplug_pt;
+	int hotplug_fd;
 	
 	struct dddvb_fe dvbfe[DDDVB_MAX_DVB_FE];
 	struct dddvb_ca dvbca[DDDVB_MAX_DVB_CA];
@@ -177,6 +383,7 @@ struct dddvb {
 
 	unsigned int get_ts;
 	unsigned int use_ca;
+	unsigned int hotplug;
 };
 
 int dddvb_dvb_init(struct dddvb *dd);
@@ -184,8 +391,14 @@ int parse_config(struct dddvb *dd, char *name, char *sec,
 		 void (*cb)(struct dddvb *, char *, char *) );
 void dddvb_fe_handle(struct dddvb_fe *fe);
 int dddvb_fe_tune(struct dddvb_fe *fe, struct dddvb_params *p);
+int dddvb_fe_do_tune(struct dddvb_fe *fe, struct dddvb_params *p);
 int dddvb_fe_start(struct dddvb_fe *fe);
 int scan_dvbca(struct dddvb *dd);
+int dvb_sysfs_scan(const char *type, uint32_t *ids, int max);
+int dddvb_dvb_rescan(struct dddvb *dd);
+void dddvb_crc_init(void);
+uint8_t dddvb_crc8(const uint8_t *p, uint32_t len);
+uint32_t dddvb_crc32(const uint8_t *p, uint32_t len);
 
 
 #endif /* _DDDVB_H_ */
@@ -14,6 +14,10 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <dirent.h>
+#include <ctype.h>
+#include <poll.h>
+#include <sys/inotify.h>
 
 #define DTV_SCRAMBLING_SEQUENCE_INDEX 70
 #define DTV_INPUT                     71
@@ -859,7 +863,7 @@ int dddvb_fe_start(struct dddvb_fe *fe)
 	return pthread_create(&fe->pt, NULL, (void *) dddvb_fe_handle, fe); 
 }
 
-int dddvb_fe_tune(struct dddvb_fe *fe, struct dddvb_params *p)
+int dddvb_fe_do_tune(struct dddvb_fe *fe, struct dddvb_params *p)
 {
 	int ret = 0;
 
@@ -873,6 +877,21 @@ int dddvb_fe_tune(struct dddvb_fe *fe, struct dddvb_params *p)
 	return ret;
 }
 
+/* a frontend shared by several users keeps the transponder it has */
+int dddvb_fe_tune(struct dddvb_fe *fe, struct dddvb_params *p)
+{
+	struct dddvb *dd = fe->dd;
+
+	pthread_mutex_lock(&dd->lock);
+	if (fe->users > 1) {
+		pthread_mutex_unlock(&dd->lock);
+		dbgprintf(DEBUG_DVB, "fe %d shared by %u users\n", fe->nr, fe->users);
+		return -EBUSY;
+	}
+	pthread_mutex_unlock(&dd->lock);
+	return dddvb_fe_do_tune(fe, p);
+}
+
 int dddvb_fe_get(struct dddvb_fe *fe, struct dddvb_params *p)
 {
 	int ret = 0;
@@ -884,17 +903,45 @@ int dddvb_fe_get(struct dddvb_fe *fe, struct dddvb_params *p)
 	return ret;
 }
 
+static void dddvb_fe_count(struct dddvb *dd, struct dddvb_fe *fe, int d)
+{
+	if (fe->type & (1UL << SYS_DVBS2))
+		dd->dvbs2num += d;
+	if (fe->type & (1UL << SYS_DVBT2))
+		dd->dvbt2num += d;
+	else if (fe->type & (1UL << SYS_DVBT))
+		dd->dvbtnum += d;
+	if (fe->type & (1UL << SYS_DVBC2))
+		dd->dvbc2num += d;
+	else if (fe->type & (1UL << SYS_DVBC_ANNEX_A))
+		dd->dvbcnum += d;
+}
+
+/* an idle entry of a removed frontend is reused before a new one */
+static struct dddvb_fe *dddvb_fe_slot(struct dddvb *dd)
+{
+	int i;
+
+	for (i = 0; i < dd->dvbfe_num; i++)
+		if (dd->dvbfe[i].removed && !dd->dvbfe[i].state)
+			return &dd->dvbfe[i];
+	if (dd->dvbfe_num >= DDDVB_MAX_DVB_FE)
+		return NULL;
+	return &dd->dvbfe[dd->dvbfe_num];
+}
+
 static int dddvb_fe_init(struct dddvb *dd, int a, int f, int fd)
 {
 	struct dtv_properties dps;
 	struct dtv_property dp[10];
 	struct dddvb_fe *fe;
-	int r;
-	uint32_t i, ds;
+	int r, nr;
+	uint32_t i, ds, type = 0;
 
-	if (dd->dvbfe_num >= DDDVB_MAX_DVB_FE)
+	fe = dddvb_fe_slot(dd);
+	if (!fe)
 		return -1;
-	fe = &dd->dvbfe[dd->dvbfe_num];
+	nr = fe - dd->dvbfe;
 
 	r = snprintf(fe->name, sizeof(fe->name), "/dev/dvb/adapter%d/frontend%d", a, f);
 	if (r >= sizeof(fe->name))
@@ -912,49 +959,219 @@ static int dddvb_fe_init(struct dddvb *dd, int a, int f, int fd)
 	for (i = 0; i < dp[0].u.buffer.len; i++) {
 		ds = dp[0].u.buffer.data[i];
 		dbgprintf(DEBUG_DVB, "delivery system %d\n", ds);
-		fe->type |= (1UL << ds);
+		type |= (1UL << ds);
 	}
-	dbgprintf(DEBUG_DVB, "fe %d type = %08x\n", dd->dvbfe_num, fe->type);
-	if (!fe->type)
+	dbgprintf(DEBUG_DVB, "fe %d type = %08x\n", nr, type);
+	if (!type)
 		return -1;
 
 	fe->dd = dd;
 	fe->anum = a;
 	fe->fnum = f;
-	fe->nr = dd->dvbfe_num;
-	
-	if (fe->type & (1UL << SYS_DVBS2))
-		dd->dvbs2num++;
-	if (fe->type & (1UL << SYS_DVBT2))
-		dd->dvbt2num++;
-	else if (fe->type & (1UL << SYS_DVBT))
-		dd->dvbtnum++;
-	if (fe->type & (1UL << SYS_DVBC2))
-		dd->dvbc2num++;
-	else if (fe->type & (1UL << SYS_DVBC_ANNEX_A))
-		dd->dvbcnum++;
-
+	fe->nr = nr;
+	fe->type = type;
+	dddvb_fe_count(dd, fe, 1);
+
+	if (fe->removed) {
+		dbgprintf(DEBUG_DVB, "fe %d reused for %d/%d\n", nr, a, f);
+		fe->removed = 0;
+		return 0;
+	}
 	dd->dvbfe_num++;
 	pthread_mutex_init(&fe->mutex, 0);
 	return 0;
 }
 
-static int scan_dvbfe(struct dddvb *dd)
+static int cmp_dvb_id(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Collect all DVB devices of the given type ("frontend", "ca", ...)
+ * registered in sysfs as (adapter << 8) | device, sorted like the
+ * old brute force scan would have found them.
+ * Returns -1 if the dvb class is not available in sysfs.
+ */
+int dvb_sysfs_scan(const char *type, uint32_t *ids, int max)
+{
+	DIR *dir;
+	struct dirent *de;
+	size_t tlen = strlen(type);
+	unsigned long a, f;
+	char *p;
+	int n = 0;
+
+	dir = opendir("/sys/class/dvb");
+	if (!dir)
+		return -1;
+	while (n < max && (de = readdir(dir))) {
+		if (strncmp(de->d_name, "dvb", 3) || !isdigit(de->d_name[3]))
+			continue;
+		a = strtoul(de->d_name + 3, &p, 10);
+		if (*p++ != '.' || strncmp(p, type, tlen))
+			continue;
+		p += tlen;
+		if (!isdigit(*p))
+			continue;
+		f = strtoul(p, &p, 10);
+		if (*p || a > 255 || f > 255)
+			continue;
+		ids[n++] = (a << 8) | f;
+	}
+	closedir(dir);
+	qsort(ids, n, sizeof(ids[0]), cmp_dvb_id);
+	return n;
+}
+
+static int dddvb_fe_known(struct dddvb *dd, int a, int f)
+{
+	int i;
+
+	for (i = 0; i < dd->dvbfe_num; i++)
+		if (!dd->dvbfe[i].removed &&
+		    dd->dvbfe[i].anum == a && dd->dvbfe[i].fnum == f)
+			return 1;
+	return 0;
+}
+
+static int dddvb_fe_add(struct dddvb *dd, int a, int f)
 {
-	int a, f, fd;
 	char fname[80];
+	int fd, ret;
 
-	for (a = 0; a < 256; a++) {
-		for (f = 0; f < 24; f++) {
-			sprintf(fname, "/dev/dvb/adapter%d/frontend%d", a, f); 
-			fd = open(fname, O_RDONLY);
-			if (fd >= 0) {
-				dddvb_fe_init(dd, a, f, fd);
-				close(fd);
-			}
-		}
+	sprintf(fname, "/dev/dvb/adapter%d/frontend%d", a, f);
+	fd = open(fname, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	ret = dddvb_fe_init(dd, a, f, fd);
+	close(fd);
+	return ret;
+}
+
+static int scan_dvbfe(struct dddvb *dd)
+{
+	uint32_t ids[DDDVB_MAX_DVB_FE];
+	int a, f, i, n;
+
+	n = dvb_sysfs_scan("frontend", ids, DDDVB_MAX_DVB_FE);
+	if (n >= 0) {
+		for (i = 0; i < n; i++)
+			dddvb_fe_add(dd, ids[i] >> 8, ids[i] & 0xff);
+	} else {
+		for (a = 0; a < 256; a++)
+			for (f = 0; f < 24; f++)
+				dddvb_fe_add(dd, a, f);
 	}
 	dbgprintf(DEBUG_DVB, "Found %d frontends\n", dd->dvbfe_num);
+	return 0;
+}
+
+/*
+ * Frontends which disappeared from sysfs are marked removed, so they are
+ * no longer allocated and an adapter which comes back under the same
+ * numbers is probed again. Returns the number of frontends added.
+ */
+int dddvb_dvb_rescan(struct dddvb *dd)
+{
+	uint32_t ids[DDDVB_MAX_DVB_FE], id;
+	struct dddvb_fe *fe;
+	int i, j, n, num = 0;
+
+	n = dvb_sysfs_scan("frontend", ids, DDDVB_MAX_DVB_FE);
+	if (n < 0)
+		return n;
+	pthread_mutex_lock(&dd->lock);
+	for (i = 0; i < dd->dvbfe_num; i++) {
+		fe = &dd->dvbfe[i];
+		if (fe->removed)
+			continue;
+		id = (fe->anum << 8) | fe->fnum;
+		for (j = 0; j < n; j++)
+			if (ids[j] == id)
+				break;
+		if (j < n)
+			continue;
+		dbgprintf(DEBUG_DVB, "fe %d %d/%d removed\n",
+			  fe->nr, fe->anum, fe->fnum);
+		dddvb_fe_count(dd, fe, -1);
+		fe->removed = 1;
+	}
+	for (i = 0; i < n; i++)
+		if (!dddvb_fe_known(dd, ids[i] >> 8, ids[i] & 0xff) &&
+		    !dddvb_fe_add(dd, ids[i] >> 8, ids[i] & 0xff))
+			num++;
+	pthread_mutex_unlock(&dd->lock);
+	dbgprintf(DEBUG_DVB, "Found %d new frontends\n", num);
+	return num;
+}
+
+static void hotplug_watch_adapters(int fd)
+{
+	DIR *dir;
+	struct dirent *de;
+	char path[80];
+
+	dir = opendir("/dev/dvb");
+	if (!dir)
+		return;
+	while ((de = readdir(dir))) {
+		if (strncmp(de->d_name, "adapter", 7))
+			continue;
+		snprintf(path, sizeof(path), "/dev/dvb/%s", de->d_name);
+		inotify_add_watch(fd, path, IN_CREATE | IN_ATTRIB | IN_DELETE);
+	}
+	closedir(dir);
+}
+
+/*
+ * Watch /dev/dvb and the adapter directories below it and add frontends
+ * as soon as their device nodes show up, or mark them removed when they
+ * go away. IN_ATTRIB catches udev fixing
+ * up the permissions after the node was created. Watches are added
+ * again for every event since adding an existing one is a no-op.
+ */
+static void *dvb_hotplug(void *arg)
+{
+	struct dddvb *dd = arg;
+	struct pollfd pfd;
+	char buf[4096];
+	int n;
+
+	pfd.events = POLLIN;
+	pfd.fd = dd->hotplug_fd;
+	/* catch up on nodes created before the watches were in place */
+	dddvb_dvb_rescan(dd);
+	while (!dd->exit) {
+		if (poll(&pfd, 1, 1000) <= 0)
+			continue;
+		n = read(dd->hotplug_fd, buf, sizeof(buf));
+		if (n <= 0)
+			continue;
+		inotify_add_watch(dd->hotplug_fd, "/dev/dvb", IN_CREATE | IN_DELETE);
+		hotplug_watch_adapters(dd->hotplug_fd);
+		dddvb_dvb_rescan(dd);
+	}
+	return NULL;
+}
+
+static int dvb_hotplug_start(struct dddvb *dd)
+{
+	dd->hotplug_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (dd->hotplug_fd < 0)
+		return -1;
+	/* /dev/dvb itself is removed with the last adapter */
+	inotify_add_watch(dd->hotplug_fd, "/dev", IN_CREATE);
+	inotify_add_watch(dd->hotplug_fd, "/dev/dvb", IN_CREATE | IN_DELETE);
+	hotplug_watch_adapters(dd->hotplug_fd);
+	if (pthread_create(&dd->hotplug_pt, NULL, dvb_hotplug, dd)) {
+		close(dd->hotplug_fd);
+		dd->hotplug_fd = -1;
+		return -1;
+	}
+	return 0;
 }
 
 void scif_config(struct dddvb *dd, char *name, char *val)
@@ -1085,6 +1302,7 @@ void ca_config(struct dddvb *dd, char *name, char *val)
 int dddvb_dvb_init(struct dddvb *dd)
 {
 	pthread_mutex_init(&dd->uni_lock, 0);
+	dd->hotplug_fd = -1;
 	scan_dvbfe(dd);
 	parse_config(dd, "", "scif", &scif_config);
 	set_lnb(dd, 0, 0, 9750000, 10600000, 11700000);
@@ -1110,6 +1328,8 @@ int dddvb_dvb_init(struct dddvb *dd)
 	if (dd->use_ca)
 		scan_dvbca(dd);
 #endif
+	if (dd->hotplug)
+		dvb_hotplug_start(dd);
 }
 
 
@@ -56,13 +56,55 @@
 #define LIBDDDVB_EXPORTED
 #endif
 	
+/*
+ * flags: bits 0-7 debug mask, 0x100 no TS access, 0x200 no CA support,
+ * 0x400 no hotplug thread. Without 0x400 frontends which appear later
+ * are added automatically and removed ones are no longer allocated
+ * (CA slots are only scanned at init).
+ * dddvb_rescan() does the same scan on demand.
+ */
 LIBDDDVB_EXPORTED struct dddvb *dddvb_init(char *config, uint32_t flags);
+LIBDDDVB_EXPORTED int dddvb_rescan(struct dddvb *dd);
 LIBDDDVB_EXPORTED int dddvb_dvb_tune(struct dddvb_fe *fe, struct dddvb_params *p);
 LIBDDDVB_EXPORTED struct dddvb_fe *dddvb_fe_alloc(struct dddvb *dd, uint32_t type);
 LIBDDDVB_EXPORTED struct dddvb_fe *dddvb_fe_alloc_num(struct dddvb *dd, uint32_t type, uint32_t num);
+LIBDDDVB_EXPORTED struct dddvb_fe *dddvb_fe_alloc_tune(struct dddvb *dd, struct dddvb_params *p);
+LIBDDDVB_EXPORTED void dddvb_fe_release(struct dddvb_fe *fe);
 LIBDDDVB_EXPORTED int dddvb_ca_write(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len);
 LIBDDDVB_EXPORTED int dddvb_ca_read(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len);
 LIBDDDVB_EXPORTED int dddvb_ca_set_pmts(struct dddvb *dd, uint32_t nr, uint8_t **pmts);
+LIBDDDVB_EXPORTED struct dddvb_ts *dddvb_ts_open(struct dddvb_fe *fe);
+LIBDDDVB_EXPORTED struct dddvb_ts *dddvb_ts_open_fd(int fd);
+LIBDDDVB_EXPORTED void dddvb_ts_close(struct dddvb_ts *ts);
+LIBDDDVB_EXPORTED struct dddvb_ts_sub *dddvb_ts_subscribe(struct dddvb_ts *ts, uint32_t flags);
+LIBDDDVB_EXPORTED void dddvb_ts_unsubscribe(struct dddvb_ts_sub *sub);
+LIBDDDVB_EXPORTED int dddvb_ts_sub_pid(struct dddvb_ts_sub *sub, uint16_t pid, int on);
+LIBDDDVB_EXPORTED int dddvb_ts_sub_fd(struct dddvb_ts_sub *sub);
+LIBDDDVB_EXPORTED int dddvb_ts_sub_read(struct dddvb_ts_sub *sub, const uint8_t **pkt, int max);
+LIBDDDVB_EXPORTED void dddvb_ts_sub_ack(struct dddvb_ts_sub *sub, int n);
+LIBDDDVB_EXPORTED int dddvb_ca_stream_start(struct dddvb *dd, uint32_t nr);
+LIBDDDVB_EXPORTED void dddvb_ca_stream_stop(struct dddvb *dd, uint32_t nr);
+LIBDDDVB_EXPORTED int dddvb_ca_stream_write(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len);
+LIBDDDVB_EXPORTED int dddvb_ca_stream_read(struct dddvb *dd, uint32_t nr, uint8_t *buf, uint32_t len);
+LIBDDDVB_EXPORTED void dddvb_scan_params_init(struct dddvb_scan_params *sp);
+LIBDDDVB_EXPORTED int dddvb_scan(struct dddvb_fe *fe, struct dddvb_scan_params *sp, struct dddvb_carrier *car, int max);
+LIBDDDVB_EXPORTED struct dddvb_bbf *dddvb_bbf_alloc(uint32_t nframes);
+LIBDDDVB_EXPORTED void dddvb_bbf_free(struct dddvb_bbf *bbf);
+LIBDDDVB_EXPORTED int dddvb_bbf_put(struct dddvb_bbf *bbf, const uint8_t **pkt, int n);
+LIBDDDVB_EXPORTED struct dddvb_bbf *dddvb_bbf_open(struct dddvb_ts *ts, uint32_t nframes);
+LIBDDDVB_EXPORTED void dddvb_bbf_close(struct dddvb_bbf *bbf);
+LIBDDDVB_EXPORTED int dddvb_bbf_fd(struct dddvb_bbf *bbf);
+LIBDDDVB_EXPORTED const struct dddvb_bbframe *dddvb_bbf_get(struct dddvb_bbf *bbf);
+LIBDDDVB_EXPORTED void dddvb_bbf_release(struct dddvb_bbf *bbf);
+LIBDDDVB_EXPORTED int dddvb_bbf_gse(struct dddvb_bbf *bbf, dddvb_gse_cb cb, void *priv);
+LIBDDDVB_EXPORTED int dddvb_bbf_gse_tun(struct dddvb_bbf *bbf, const char *name);
+LIBDDDVB_EXPORTED struct dddvb_split *dddvb_split_alloc(void);
+LIBDDDVB_EXPORTED void dddvb_split_free(struct dddvb_split *sp);
+LIBDDDVB_EXPORTED int dddvb_split_add(struct dddvb_split *sp, uint32_t stream, int fd, dddvb_split_cb cb, void *priv);
+LIBDDDVB_EXPORTED int dddvb_split_pid(struct dddvb_split *sp, int out, uint16_t pid, int on);
+LIBDDDVB_EXPORTED int dddvb_split_bbframe(struct dddvb_split *sp, const struct dddvb_bbframe *fr);
+LIBDDDVB_EXPORTED void dddvb_split_t2mi_pid(struct dddvb_split *sp, uint16_t pid);
+LIBDDDVB_EXPORTED int dddvb_split_ts(struct dddvb_split *sp, const uint8_t **pkt, int n);
 
 static inline void dddvb_get_ts(struct dddvb *dd, uint32_t val) {
 	dd->get_ts = val;
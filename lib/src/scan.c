@@ -0,0 +1,442 @@
+#include "libdddvb.h"
+#include "dddvb.h"
+#include "debug.h"
+
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+/*
+ * Spectrum scan and carrier discovery for MaxSX8 frontends.
+ *
+ * The demod is switched to IQ sample mode at the fixed ADC rate with the
+ * SCAN flag and the RF gain optimized and frozen for FFT (see
+ * docs/iq_samples). The band is swept in steps of 4/5 of the sample rate.
+ * For each step an averaged power spectrum is computed and its central
+ * part is stitched into a spectrum of the whole band.
+ *
+ * Carriers are runs of bins above a noise floor, the floor being the
+ * minimum of the smoothed spectrum over the width of the widest carrier.
+ * The -3 dB width of a run is taken as symbol rate. Each candidate can be
+ * confirmed with a short tune attempt.
+ */
+
+#define SCAN_ADC_RATE    64583333   /* 1550 MHz / 24 */
+#define SCAN_IQ_PID      0x200
+/* samples at ADC rate, SCAN mode, optimize RF gain and freeze for FFT */
+#define SCAN_IQ_ID       (0x20000000 | 0x00010000 | 0x80)
+#define SCAN_USE_NUM     4
+#define SCAN_USE_DEN     5
+#define SCAN_SETTLE_MS   30
+#define SCAN_CAPTURE_MS  500
+#define SCAN_SMOOTH      4          /* half width of smoothing in bins */
+#define SCAN_MAX_BW      72000000   /* Hz, widest carrier expected */
+
+struct scan_fft {
+	uint32_t n;
+	uint32_t *rev;
+	float *tw_re;   /* twiddles of the stage with half size h at h - 1 */
+	float *tw_im;
+	float *win;
+	float *si, *sq;
+	float *re, *im;
+	float *pwr;
+};
+
+static uint64_t scan_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static void fft_free(struct scan_fft *f)
+{
+	free(f->rev);
+	free(f->tw_re);
+	free(f->tw_im);
+	free(f->win);
+	free(f->si);
+	free(f->sq);
+	free(f->re);
+	free(f->im);
+	free(f->pwr);
+}
+
+static int fft_init(struct scan_fft *f, uint32_t n)
+{
+	uint32_t i, j, h, bits;
+
+	memset(f, 0, sizeof(*f));
+	if (n < 16 || (n & (n - 1)))
+		return -EINVAL;
+	f->n = n;
+	f->rev = malloc(n * sizeof(uint32_t));
+	f->tw_re = malloc(n * sizeof(float));
+	f->tw_im = malloc(n * sizeof(float));
+	f->win = malloc(n * sizeof(float));
+	f->si = malloc(n * sizeof(float));
+	f->sq = malloc(n * sizeof(float));
+	f->re = malloc(n * sizeof(float));
+	f->im = malloc(n * sizeof(float));
+	f->pwr = malloc(n * sizeof(float));
+	if (!f->rev || !f->tw_re || !f->tw_im || !f->win || !f->si ||
+	    !f->sq || !f->re || !f->im || !f->pwr) {
+		fft_free(f);
+		return -ENOMEM;
+	}
+	for (bits = 0; (1U << bits) < n; bits++)
+		;
+	for (i = 0; i < n; i++) {
+		for (j = 0, h = 0; h < bits; h++)
+			j |= ((i >> h) & 1) << (bits - 1 - h);
+		f->rev[i] = j;
+		f->win[i] = 0.5f - 0.5f * cosf(2.0f * M_PI * i / n);
+	}
+	for (h = 1; h < n; h <<= 1)
+		for (j = 0; j < h; j++) {
+			f->tw_re[h - 1 + j] = cosf(-M_PI * j / h);
+			f->tw_im[h - 1 + j] = sinf(-M_PI * j / h);
+		}
+	return 0;
+}
+
+/* one radix-2 butterfly row, contiguous so the compiler can vectorize it */
+static void fft_butterflies(float *restrict ar, float *restrict ai,
+			    float *restrict br, float *restrict bi,
+			    const float *restrict wr, const float *restrict wi,
+			    uint32_t h)
+{
+	uint32_t j;
+
+	for (j = 0; j < h; j++) {
+		float tr = br[j] * wr[j] - bi[j] * wi[j];
+		float ti = br[j] * wi[j] + bi[j] * wr[j];
+
+		br[j] = ar[j] - tr;
+		bi[j] = ai[j] - ti;
+		ar[j] += tr;
+		ai[j] += ti;
+	}
+}
+
+/* windowed FFT of si/sq, power added to pwr */
+static void fft_run(struct scan_fft *f)
+{
+	uint32_t n = f->n, i, h, k;
+	float *re = f->re, *im = f->im;
+
+	for (i = 0; i < n; i++) {
+		re[f->rev[i]] = f->si[i] * f->win[i];
+		im[f->rev[i]] = f->sq[i] * f->win[i];
+	}
+	for (h = 1; h < n; h <<= 1)
+		for (k = 0; k < n; k += 2 * h)
+			fft_butterflies(re + k, im + k, re + k + h, im + k + h,
+					f->tw_re + h - 1, f->tw_im + h - 1, h);
+	for (i = 0; i < n; i++)
+		f->pwr[i] += re[i] * re[i] + im[i] * im[i];
+}
+
+static void scan_drain(struct dddvb_ts_sub *sub, uint32_t ms)
+{
+	const uint8_t *pkt[256];
+	struct pollfd pfd = { .fd = dddvb_ts_sub_fd(sub), .events = POLLIN };
+	uint64_t end = scan_ms() + ms;
+	int n;
+
+	while (scan_ms() < end) {
+		poll(&pfd, 1, 5);
+		n = dddvb_ts_sub_read(sub, pkt, 256);
+		if (n > 0)
+			dddvb_ts_sub_ack(sub, n);
+	}
+}
+
+/* capture and average up to sp->averages spectra, returns their number */
+static int scan_capture(struct dddvb_ts_sub *sub, struct scan_fft *f,
+			struct dddvb_scan_params *sp)
+{
+	const uint8_t *pkt[64];
+	struct pollfd pfd = { .fd = dddvb_ts_sub_fd(sub), .events = POLLIN };
+	uint64_t end = scan_ms() + SCAN_CAPTURE_MS;
+	uint32_t fill = 0, nfft = 0, i, j;
+	int n, cc = -1;
+
+	memset(f->pwr, 0, f->n * sizeof(float));
+	while (nfft < sp->averages && scan_ms() < end) {
+		poll(&pfd, 1, 10);
+		n = dddvb_ts_sub_read(sub, pkt, 64);
+		if (n == -EOVERFLOW)
+			fill = 0;
+		if (n <= 0)
+			continue;
+		for (i = 0; i < n && nfft < sp->averages; i++) {
+			const uint8_t *p = pkt[i];
+
+			if (p[0] != 0x47)
+				continue;
+			if (cc >= 0 && (p[3] & 0x0f) != ((cc + 1) & 0x0f))
+				fill = 0;
+			cc = p[3] & 0x0f;
+			for (j = 4; j < 188; j += 2) {
+				f->si[fill] = (int8_t) p[j];
+				f->sq[fill] = (int8_t) p[j + 1];
+				if (++fill < f->n)
+					continue;
+				fft_run(f);
+				fill = 0;
+				if (++nfft == sp->averages)
+					break;
+			}
+		}
+		dddvb_ts_sub_ack(sub, n);
+	}
+	return nfft;
+}
+
+static int scan_tune(struct dddvb_fe *fe, struct dddvb_scan_params *sp,
+		     uint32_t freq, uint32_t sr, uint32_t id)
+{
+	struct dddvb_params p;
+
+	dddvb_param_init(&p);
+	dddvb_set_delsys(&p, SYS_DVBS2);
+	dddvb_set_frequency(&p, freq);
+	dddvb_set_symbol_rate(&p, sr);
+	dddvb_set_polarization(&p, sp->pol);
+	dddvb_set_src(&p, sp->src);
+	dddvb_set_id(&p, id);
+	return dddvb_fe_tune(fe, &p);
+}
+
+/* same rule as tune_sat(): low LOF above the RF frequency mirrors the band */
+static int scan_inverted(struct dddvb_fe *fe, struct dddvb_scan_params *sp,
+			 uint32_t freq)
+{
+	uint32_t lnbc = 0;
+
+	if (sp->src != DDDVB_UNDEF)
+		lnbc = sp->src & (DDDVB_MAX_SOURCE - 1);
+	return freq > 3000000 && fe->lofs[lnbc] <= 10000000;
+}
+
+static void scan_stitch(struct scan_fft *f, float *spec, uint32_t len,
+			double bin, double off, uint32_t nfft, int inv)
+{
+	uint32_t n = f->n, k;
+	double use = SCAN_ADC_RATE * SCAN_USE_NUM / SCAN_USE_DEN / 2.0;
+	double d;
+	int64_t idx;
+	float v;
+
+	/* the DC bin carries the IQ offset, replace it by its neighbours */
+	f->pwr[0] = (f->pwr[1] + f->pwr[n - 1]) / 2;
+	for (k = 0; k < n; k++) {
+		d = ((int32_t) k - (int32_t) (n / 2)) * bin;
+		if (fabs(d) > use)
+			continue;
+		if (inv)
+			d = -d;
+		idx = lround((off + d) / bin);
+		if (idx < 0 || idx >= len)
+			continue;
+		v = 10.0f * log10f(f->pwr[(k + n / 2) & (n - 1)] / nfft + 1e-12f);
+		spec[idx] = isnan(spec[idx]) ? v : (spec[idx] + v) / 2;
+	}
+}
+
+static int scan_detect(struct dddvb_scan_params *sp, const float *spec,
+		       uint32_t len, double bin, struct dddvb_carrier *car,
+		       int max)
+{
+	float *s, *fl, thr = sp->threshold / 10.0f;
+	uint32_t k, w = SCAN_MAX_BW / bin / 2, a, b, lo, hi;
+	int64_t i, j, m;
+	int num = 0;
+
+	s = malloc(len * sizeof(float));
+	fl = malloc(len * sizeof(float));
+	if (!s || !fl) {
+		free(s);
+		free(fl);
+		return -ENOMEM;
+	}
+	for (k = 0; k < len; k++) {
+		float sum = 0;
+
+		for (m = 0, j = (int64_t) k - SCAN_SMOOTH; j <= k + SCAN_SMOOTH; j++) {
+			if (j < 0 || j >= len || isnan(spec[j]))
+				continue;
+			sum += spec[j];
+			m++;
+		}
+		s[k] = m ? sum / m : -1000.0f;
+	}
+	for (k = 0; k < len; k++) {
+		float min = 1000.0f;
+
+		for (i = (int64_t) k - w; i <= (int64_t) k + w; i++)
+			if (i >= 0 && i < len && s[i] > -1000.0f && s[i] < min)
+				min = s[i];
+		fl[k] = min;
+	}
+	for (k = 0; k < len && num < max; ) {
+		float peak, plateau, floor;
+
+		if (s[k] - fl[k] < thr) {
+			k++;
+			continue;
+		}
+		/* run above threshold, short dips are bridged */
+		for (a = b = k; k < len; k++) {
+			if (s[k] - fl[k] >= thr)
+				b = k;
+			else if (k - b > SCAN_SMOOTH)
+				break;
+		}
+		for (peak = s[a], i = a; i <= b; i++)
+			if (s[i] > peak)
+				peak = s[i];
+		for (plateau = floor = 0, m = 0, i = a; i <= b; i++)
+			if (s[i] >= peak - 6.0f) {
+				plateau += s[i];
+				floor += fl[i];
+				m++;
+			}
+		plateau /= m;
+		floor /= m;
+		for (lo = a; lo < b && s[lo] < plateau - 3.0f; lo++)
+			;
+		for (hi = b; hi > lo && s[hi] < plateau - 3.0f; hi--)
+			;
+		car[num].sr = ((uint32_t) ((hi - lo + 1) * bin) + 500) / 1000 * 1000;
+		if (car[num].sr < sp->min_sr)
+			continue;
+		car[num].freq = sp->freq_start + lround((lo + hi) * bin / 2000.0);
+		car[num].level = lround((plateau - floor) * 10);
+		car[num].lock = 0;
+		dbgprintf(DEBUG_DVB, "scan: carrier %u kHz sr %u level %d\n",
+			  car[num].freq, car[num].sr, car[num].level);
+		num++;
+	}
+	free(s);
+	free(fl);
+	return num;
+}
+
+static void scan_confirm(struct dddvb_fe *fe, struct dddvb_scan_params *sp,
+			 struct dddvb_carrier *car)
+{
+	uint64_t end;
+
+	scan_tune(fe, sp, car->freq, car->sr, DDDVB_UNDEF);
+	end = scan_ms() + sp->confirm_ms;
+	while (scan_ms() < end) {
+		if (dddvb_get_stat(fe) == 0x1f) {
+			car->lock = 1;
+			break;
+		}
+		usleep(20000);
+	}
+}
+
+LIBDDDVB_EXPORTED void dddvb_scan_params_init(struct dddvb_scan_params *sp)
+{
+	memset(sp, 0, sizeof(*sp));
+	sp->freq_start = 10700000;
+	sp->freq_end = 12750000;
+	sp->pol = 0;
+	sp->src = DDDVB_UNDEF;
+	sp->fft_size = 1024;
+	sp->averages = 16;
+	sp->threshold = 60;
+	sp->min_sr = 1000000;
+	sp->confirm_ms = 1000;
+}
+
+/*
+ * Sweep sp->freq_start to sp->freq_end on an allocated SX8 frontend and
+ * return the number of carriers stored in car.
+ */
+LIBDDDVB_EXPORTED int dddvb_scan(struct dddvb_fe *fe, struct dddvb_scan_params *sp,
+				 struct dddvb_carrier *car, int max)
+{
+	struct scan_fft f;
+	struct dddvb_ts *ts;
+	struct dddvb_ts_sub *sub;
+	double bin, step;
+	float *spec;
+	uint32_t len, k, nfft;
+	uint64_t t0 = scan_ms();
+	int ret, i;
+
+	if (sp->freq_end <= sp->freq_start || !sp->averages)
+		return -EINVAL;
+	ret = fft_init(&f, sp->fft_size);
+	if (ret < 0)
+		return ret;
+	bin = (double) SCAN_ADC_RATE / f.n;
+	step = (double) SCAN_ADC_RATE * SCAN_USE_NUM / SCAN_USE_DEN;
+	len = (sp->freq_end - sp->freq_start) * 1000.0 / bin + 1;
+	spec = malloc(len * sizeof(float));
+	if (!spec) {
+		fft_free(&f);
+		return -ENOMEM;
+	}
+	for (k = 0; k < len; k++)
+		spec[k] = NAN;
+
+	ts = dddvb_ts_open(fe);
+	sub = ts ? dddvb_ts_subscribe(ts, 0) : NULL;
+	if (!sub) {
+		ret = -EIO;
+		goto out;
+	}
+	dddvb_ts_sub_pid(sub, SCAN_IQ_PID, 1);
+
+	for (i = 0; ; i++) {
+		double off = step / 2 + i * step;
+		uint32_t freq = sp->freq_start + lround(off / 1000);
+
+		if (off - step / 2 >= (sp->freq_end - sp->freq_start) * 1000.0)
+			break;
+		scan_tune(fe, sp, freq, SCAN_ADC_RATE, SCAN_IQ_ID);
+		scan_drain(sub, SCAN_SETTLE_MS);
+		nfft = scan_capture(sub, &f, sp);
+		dbgprintf(DEBUG_DVB, "scan: %u kHz, %u spectra\n", freq, nfft);
+		if (nfft)
+			scan_stitch(&f, spec, len, bin, off, nfft,
+				    scan_inverted(fe, sp, freq));
+	}
+	dddvb_ts_close(ts);
+	ts = NULL;
+
+	ret = scan_detect(sp, spec, len, bin, car, max);
+	if (ret > 0 && sp->confirm_ms)
+		for (i = 0; i < ret; i++)
+			scan_confirm(fe, sp, &car[i]);
+
+	if (sp->get_spectrum) {
+		sp->spectrum = malloc(len * sizeof(int16_t));
+		if (sp->spectrum) {
+			for (k = 0; k < len; k++)
+				sp->spectrum[k] = isnan(spec[k]) ?
+					INT16_MIN : lround(spec[k] * 10);
+			sp->spectrum_len = len;
+			sp->spectrum_step = lround(bin);
+		}
+	}
+	dbgprintf(DEBUG_DVB, "scan: %d carriers in %llu ms\n", ret,
+		  (unsigned long long) (scan_ms() - t0));
+out:
+	if (ts)
+		dddvb_ts_close(ts);
+	free(spec);
+	fft_free(&f);
+	return ret;
+}
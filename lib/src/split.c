@@ -0,0 +1,333 @@
+#include "libdddvb.h"
+#include "dddvb.h"
+#include "debug.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+/*
+ * MIS and T2-MI splitter: recovers the transport streams of several ISIs
+ * or PLPs from one capture and feeds each to any number of outputs with
+ * their own PID filter.
+ *
+ * Input are either BBFrames from the reassembler in bbf.c (demod in
+ * BBFrame mode, all ISIs of a carrier) or TS packets of a T2-MI PID.
+ * User packets are cut from the BBFrame data fields using SYNCD, packets
+ * spanning two frames are completed from the stream's partial buffer.
+ * Output packets are batched and flushed after each input call.
+ */
+
+static int split_stream(struct dddvb_split *sp, uint32_t id)
+{
+	int i;
+
+	for (i = 0; i < sp->nstreams; i++)
+		if (sp->stream[i].id == id)
+			return i;
+	return -1;
+}
+
+static void split_flush(struct dddvb_split *sp)
+{
+	struct dddvb_split_out *o;
+	int i;
+
+	for (i = 0; i < sp->nouts; i++) {
+		o = &sp->out[i];
+		if (!o->n)
+			continue;
+		if (o->cb)
+			o->cb(o->priv, o->buf, o->n);
+		else if (write(o->fd, o->buf, o->n * 188) < 0)
+			dbgprintf(DEBUG_DVB, "split: write error %d\n", errno);
+		o->n = 0;
+	}
+}
+
+/* restore the sync byte, up points to the sync (or CRC8) position in NM */
+static void split_emit(struct dddvb_split *sp, int st, const uint8_t *up,
+		       int hem)
+{
+	struct dddvb_split_out *o;
+	const uint8_t *src = up + (hem ? 0 : 1);
+	uint32_t pid = ((src[0] & 0x1f) << 8) | src[1];
+	uint8_t *p;
+	int i;
+
+	for (i = 0; i < sp->nouts; i++) {
+		o = &sp->out[i];
+		if (o->stream != st || !(o->pidmap[pid >> 3] & (1 << (pid & 7))))
+			continue;
+		p = o->buf + o->n * 188;
+		p[0] = 0x47;
+		memcpy(p + 1, src, 187);
+		o->packets++;
+		if (++o->n == DDDVB_SPLIT_BATCH)
+			split_flush(sp);
+	}
+}
+
+static void split_frame(struct dddvb_split *sp, uint32_t id, int hem,
+			uint8_t matype1, uint16_t upl, uint16_t dfl,
+			uint16_t syncd, const uint8_t *df)
+{
+	struct dddvb_split_stream *s;
+	uint32_t n = dfl / 8, uplen, pos;
+	int st;
+
+	sp->frames++;
+	if ((matype1 >> 6) != 3)
+		return;         /* not a transport stream */
+	st = split_stream(sp, id);
+	if (st < 0)
+		return;
+	s = &sp->stream[st];
+	/* NM packets keep UPL bytes in the stream, HEM drops the sync byte */
+	uplen = hem ? 187 + ((matype1 >> 2) & 1) : upl / 8;
+	if (uplen < 187 || uplen > sizeof(s->part)) {
+		sp->sync_errors++;
+		return;
+	}
+	if (syncd == 0xffff) {
+		/* no packet starts in this frame */
+		if (s->plen && s->plen + n < uplen) {
+			memcpy(s->part + s->plen, df, n);
+			s->plen += n;
+		} else if (s->plen) {
+			sp->sync_errors++;
+			s->plen = 0;
+		}
+		return;
+	}
+	pos = syncd / 8;
+	if (pos > n) {
+		sp->sync_errors++;
+		s->plen = 0;
+		return;
+	}
+	if (s->plen) {
+		if (s->plen + pos == uplen) {
+			memcpy(s->part + s->plen, df, pos);
+			split_emit(sp, st, s->part, hem);
+		} else
+			sp->sync_errors++;
+		s->plen = 0;
+	}
+	for (; pos + uplen <= n; pos += uplen)
+		split_emit(sp, st, df + pos, hem);
+	if (pos < n) {
+		s->plen = n - pos;
+		memcpy(s->part, df + pos, s->plen);
+	}
+}
+
+LIBDDDVB_EXPORTED struct dddvb_split *dddvb_split_alloc(void)
+{
+	struct dddvb_split *sp;
+
+	dddvb_crc_init();
+	sp = calloc(1, sizeof(struct dddvb_split));
+	if (!sp)
+		return NULL;
+	sp->t2mi_pid = 0x2000;
+	sp->t2mi_cc = -1;
+	return sp;
+}
+
+LIBDDDVB_EXPORTED void dddvb_split_free(struct dddvb_split *sp)
+{
+	split_flush(sp);
+	free(sp);
+}
+
+/*
+ * Add an output for ISI or PLP stream, packets go to cb or, if cb is
+ * NULL, are written to fd. Returns the output index. No PIDs are
+ * selected initially.
+ */
+LIBDDDVB_EXPORTED int dddvb_split_add(struct dddvb_split *sp, uint32_t stream, int fd, dddvb_split_cb cb, void *priv)
+{
+	struct dddvb_split_out *o;
+	int st;
+
+	if (sp->nouts == DDDVB_SPLIT_OUTS)
+		return -ENOSPC;
+	st = split_stream(sp, stream);
+	if (st < 0) {
+		if (sp->nstreams == DDDVB_SPLIT_STREAMS)
+			return -ENOSPC;
+		st = sp->nstreams++;
+		sp->stream[st].id = stream;
+		sp->stream[st].plen = 0;
+	}
+	o = &sp->out[sp->nouts];
+	memset(o, 0, sizeof(*o));
+	o->stream = st;
+	o->fd = fd;
+	o->cb = cb;
+	o->priv = priv;
+	return sp->nouts++;
+}
+
+/* add (on != 0) or remove a PID of an output, 0x2000 selects all PIDs */
+LIBDDDVB_EXPORTED int dddvb_split_pid(struct dddvb_split *sp, int out, uint16_t pid, int on)
+{
+	struct dddvb_split_out *o;
+
+	if (out < 0 || out >= sp->nouts)
+		return -EINVAL;
+	o = &sp->out[out];
+	if (pid == 0x2000) {
+		memset(o->pidmap, on ? 0xff : 0x00, sizeof(o->pidmap));
+		return 0;
+	}
+	if (pid > 8191)
+		return -EINVAL;
+	if (on)
+		o->pidmap[pid >> 3] |= 1 << (pid & 7);
+	else
+		o->pidmap[pid >> 3] &= ~(1 << (pid & 7));
+	return 0;
+}
+
+/* split a frame from dddvb_bbf_get(), the ISI selects the stream */
+LIBDDDVB_EXPORTED int dddvb_split_bbframe(struct dddvb_split *sp, const struct dddvb_bbframe *fr)
+{
+	if (fr->len < 10 + fr->dfl / 8)
+		return -EINVAL;
+	split_frame(sp, fr->isi, fr->hem, fr->matype1, fr->upl, fr->dfl,
+		    fr->syncd, fr->data + 10);
+	split_flush(sp);
+	return 0;
+}
+
+/* T2-MI */
+
+static void t2mi_packet(struct dddvb_split *sp, const uint8_t *b, uint32_t len)
+{
+	const uint8_t *bb;
+	uint32_t plen = len - 10, crc;
+	uint8_t c8;
+	int hem;
+
+	crc = (b[len - 4] << 24) | (b[len - 3] << 16) | (b[len - 2] << 8) | b[len - 1];
+	if (dddvb_crc32(b, len - 4) != crc) {
+		sp->t2mi_errors++;
+		return;
+	}
+	if (b[0] != 0x00)
+		return;         /* only baseband frame packets */
+	/* frame_idx, plp_id, intl_frame_start, BBFrame */
+	if (plen < 3 + 10) {
+		sp->t2mi_errors++;
+		return;
+	}
+	bb = b + 6 + 3;
+	c8 = dddvb_crc8(bb, 9);
+	if (bb[9] == c8)
+		hem = 0;
+	else if (bb[9] == (c8 ^ 1))
+		hem = 1;
+	else {
+		sp->t2mi_errors++;
+		return;
+	}
+	if (10 + (((bb[4] << 8) | bb[5]) / 8) > plen - 3) {
+		sp->t2mi_errors++;
+		return;
+	}
+	split_frame(sp, b[7], hem, bb[0], (bb[2] << 8) | bb[3],
+		    (bb[4] << 8) | bb[5], (bb[7] << 8) | bb[8], bb + 10);
+}
+
+/* process complete T2-MI packets in the buffer */
+static void t2mi_parse(struct dddvb_split *sp)
+{
+	uint8_t *b = sp->t2mi_buf;
+	uint32_t pos = 0, tot;
+
+	while (sp->t2mi_len - pos >= 6) {
+		tot = 6 + (((b[pos + 4] << 8) | b[pos + 5]) + 7) / 8 + 4;
+		if (tot > DDDVB_T2MI_MAX) {
+			sp->t2mi_errors++;
+			sp->t2mi_sync = 0;
+			sp->t2mi_len = 0;
+			return;
+		}
+		if (sp->t2mi_len - pos < tot)
+			break;
+		t2mi_packet(sp, b + pos, tot);
+		pos += tot;
+	}
+	if (pos) {
+		sp->t2mi_len -= pos;
+		memmove(b, b + pos, sp->t2mi_len);
+	}
+}
+
+static void t2mi_append(struct dddvb_split *sp, const uint8_t *p, uint32_t len)
+{
+	if (!sp->t2mi_sync)
+		return;
+	if (sp->t2mi_len + len > DDDVB_T2MI_MAX) {
+		sp->t2mi_errors++;
+		sp->t2mi_sync = 0;
+		sp->t2mi_len = 0;
+		return;
+	}
+	memcpy(sp->t2mi_buf + sp->t2mi_len, p, len);
+	sp->t2mi_len += len;
+	t2mi_parse(sp);
+}
+
+/* select the PID carrying T2-MI for dddvb_split_ts(), PLP ids select streams */
+LIBDDDVB_EXPORTED void dddvb_split_t2mi_pid(struct dddvb_split *sp, uint16_t pid)
+{
+	sp->t2mi_pid = pid;
+	sp->t2mi_cc = -1;
+	sp->t2mi_sync = 0;
+	sp->t2mi_len = 0;
+}
+
+LIBDDDVB_EXPORTED int dddvb_split_ts(struct dddvb_split *sp, const uint8_t **pkt, int n)
+{
+	const uint8_t *p;
+	uint32_t off, ptr;
+	int i, cc;
+
+	for (i = 0; i < n; i++) {
+		p = pkt[i];
+		if (p[0] != 0x47 || (((p[1] & 0x1f) << 8) | p[2]) != sp->t2mi_pid)
+			continue;
+		if (!(p[3] & 0x10))
+			continue;
+		cc = p[3] & 0x0f;
+		if (sp->t2mi_cc >= 0 && cc != ((sp->t2mi_cc + 1) & 0x0f)) {
+			sp->t2mi_sync = 0;
+			sp->t2mi_len = 0;
+		}
+		sp->t2mi_cc = cc;
+		off = 4;
+		if (p[3] & 0x20)
+			off += 1 + p[4];
+		if (off >= 188)
+			continue;
+		if (!(p[1] & 0x40)) {
+			t2mi_append(sp, p + off, 188 - off);
+			continue;
+		}
+		ptr = p[off++];
+		if (off + ptr > 188) {
+			sp->t2mi_sync = 0;
+			sp->t2mi_len = 0;
+			continue;
+		}
+		t2mi_append(sp, p + off, ptr);
+		sp->t2mi_sync = 1;
+		sp->t2mi_len = 0;
+		t2mi_append(sp, p + off + ptr, 188 - off - ptr);
+	}
+	split_flush(sp);
+	return 0;
+}
@@ -0,0 +1,396 @@
+#include "libdddvb.h"
+#include "dddvb.h"
+#include "debug.h"
+
+#include <linux/dvb/dmx.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+/*
+ * TS engine: one thread reads the stream in large chunks into a shared
+ * ring and dispatches packets by PID to up to 64 subscribers. A
+ * subscriber only gets references into the shared ring, which stay
+ * valid until they are acknowledged with dddvb_ts_sub_ack().
+ *
+ * The reader waits for a subscriber which still holds references into
+ * the part of the ring it wants to refill. Subscribers without
+ * DDDVB_TS_SUB_BLOCK are given up on after DDDVB_TS_STALL_MS: their
+ * queue is flushed and their next read returns -EOVERFLOW.
+ */
+
+#define DDDVB_TS_CHUNK     512
+#define DDDVB_TS_STALL_MS  100
+
+static void ts_signal(int fd)
+{
+	uint64_t one = 1;
+
+	if (write(fd, &one, sizeof(one)) < 0)
+		return;
+}
+
+/* oldest packet the subscriber may still access */
+static int sub_oldest(struct dddvb_ts_sub *sub, uint32_t *seq)
+{
+	uint32_t rp = __atomic_load_n(&sub->rp, __ATOMIC_ACQUIRE);
+
+	if (rp == sub->wp)
+		return 0;
+	*seq = sub->q[rp & (sub->qsize - 1)];
+	return 1;
+}
+
+static uint32_t ms_since(struct timespec *t)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - t->tv_sec) * 1000 +
+		(now.tv_nsec - t->tv_nsec) / 1000000;
+}
+
+/*
+ * Wait until packets up to seq + n can be written to the ring.
+ * Subscribers wake us through ts->space when they acknowledge packets
+ * while space_wait is set.
+ */
+static void ts_wait_space(struct dddvb_ts *ts, uint32_t n)
+{
+	struct dddvb_ts_sub *sub;
+	struct timespec start, to;
+	uint32_t oldest;
+	uint64_t m;
+	int i, busy, stalled = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_mutex_lock(&ts->lock);
+	while (!ts->exit) {
+		busy = 0;
+		__atomic_store_n(&ts->space_wait, 1, __ATOMIC_SEQ_CST);
+		for (m = ts->active; m; m &= m - 1) {
+			i = __builtin_ctzll(m);
+			sub = ts->sub[i];
+			if (sub->overflow || !sub_oldest(sub, &oldest))
+				continue;
+			if (ts->seq + n - oldest <= ts->npkt)
+				continue;
+			if (!(sub->flags & DDDVB_TS_SUB_BLOCK) && stalled) {
+				dbgprintf(DEBUG_DVB, "ts sub %d stalled\n", sub->id);
+				__atomic_store_n(&sub->overflow, 1, __ATOMIC_RELEASE);
+				ts_signal(sub->evfd);
+				continue;
+			}
+			busy = 1;
+		}
+		if (!busy)
+			break;
+		if (stalled) {
+			pthread_cond_wait(&ts->space, &ts->lock);
+			continue;
+		}
+		to = start;
+		to.tv_nsec += DDDVB_TS_STALL_MS * 1000000;
+		to.tv_sec += to.tv_nsec / 1000000000;
+		to.tv_nsec %= 1000000000;
+		if (pthread_cond_timedwait(&ts->space, &ts->lock, &to) == ETIMEDOUT ||
+		    ms_since(&start) >= DDDVB_TS_STALL_MS)
+			stalled = 1;
+	}
+	__atomic_store_n(&ts->space_wait, 0, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&ts->lock);
+}
+
+static void ts_dispatch(struct dddvb_ts *ts, uint8_t *buf, uint32_t n)
+{
+	struct dddvb_ts_sub *sub;
+	uint64_t m, touched = 0;
+	uint32_t i, pid;
+	int b;
+
+	pthread_mutex_lock(&ts->lock);
+	for (i = 0; i < n; i++, buf += 188) {
+		pid = ((buf[1] & 0x1f) << 8) | buf[2];
+		for (m = ts->pidmask[pid] & ts->active; m; m &= m - 1) {
+			b = __builtin_ctzll(m);
+			sub = ts->sub[b];
+			if (sub->overflow)
+				continue;
+			if (sub->wp - __atomic_load_n(&sub->rp, __ATOMIC_ACQUIRE) >=
+			    sub->qsize) {
+				sub->drops++;
+				continue;
+			}
+			sub->q[sub->wp & (sub->qsize - 1)] = ts->seq + i;
+			__atomic_store_n(&sub->wp, sub->wp + 1, __ATOMIC_RELEASE);
+			touched |= 1ULL << b;
+		}
+	}
+	ts->seq += n;
+	for (m = touched; m; m &= m - 1)
+		ts_signal(ts->sub[__builtin_ctzll(m)]->evfd);
+	pthread_mutex_unlock(&ts->lock);
+}
+
+static void *ts_reader(void *arg)
+{
+	struct dddvb_ts *ts = arg;
+	struct pollfd pfd = { .fd = ts->fd, .events = POLLIN };
+	uint32_t slot, n, pk, off = 0;
+	uint8_t *p;
+	ssize_t len;
+
+	while (!ts->exit) {
+		slot = ts->seq % ts->npkt;
+		n = ts->npkt - slot;
+		if (n > DDDVB_TS_CHUNK)
+			n = DDDVB_TS_CHUNK;
+		ts_wait_space(ts, n);
+		if (ts->exit)
+			break;
+		p = ts->buf + slot * 188;
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+		len = read(ts->fd, p + off, n * 188 - off);
+		if (len == 0)
+			break;
+		if (len < 0) {
+			if (errno == EOVERFLOW)
+				off = 0;
+			continue;
+		}
+		off += len;
+		/* resync to the first sync byte */
+		while (off && p[0] != 0x47) {
+			uint8_t *s = memchr(p + 1, 0x47, off - 1);
+
+			len = s ? s - p : off;
+			memmove(p, p + len, off - len);
+			off -= len;
+		}
+		pk = off / 188;
+		if (!pk)
+			continue;
+		off -= pk * 188;
+		ts_dispatch(ts, p, pk);
+		if (off) {
+			slot = ts->seq % ts->npkt;
+			memmove(ts->buf + slot * 188, p + pk * 188, off);
+		}
+	}
+	return NULL;
+}
+
+LIBDDDVB_EXPORTED struct dddvb_ts *dddvb_ts_open_fd(int fd)
+{
+	struct dddvb_ts *ts;
+	pthread_condattr_t ca;
+
+	ts = calloc(1, sizeof(struct dddvb_ts));
+	if (!ts)
+		return NULL;
+	ts->fd = fd;
+	ts->npkt = DDDVB_TS_PACKETS;
+	ts->buf = malloc(ts->npkt * 188);
+	if (!ts->buf) {
+		free(ts);
+		return NULL;
+	}
+	pthread_mutex_init(&ts->lock, 0);
+	pthread_condattr_init(&ca);
+	pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+	pthread_cond_init(&ts->space, &ca);
+	pthread_condattr_destroy(&ca);
+	if (pthread_create(&ts->pt, NULL, ts_reader, ts)) {
+		pthread_cond_destroy(&ts->space);
+		free(ts->buf);
+		free(ts);
+		return NULL;
+	}
+	return ts;
+}
+
+/* read the whole transport stream of a frontend through its demux */
+LIBDDDVB_EXPORTED struct dddvb_ts *dddvb_ts_open(struct dddvb_fe *fe)
+{
+	struct dmx_pes_filter_params pes;
+	struct dddvb_ts *ts;
+	char fname[80];
+	int fd;
+
+	sprintf(fname, "/dev/dvb/adapter%u/demux%u", fe->anum, fe->fnum);
+	fd = open(fname, O_RDONLY | O_NONBLOCK);
+	if (fd < 0)
+		return NULL;
+	ioctl(fd, DMX_SET_BUFFER_SIZE, 4 * 1024 * 1024);
+	memset(&pes, 0, sizeof(pes));
+	pes.pid = 0x2000;
+	pes.input = DMX_IN_FRONTEND;
+	pes.output = DMX_OUT_TSDEMUX_TAP;
+	pes.pes_type = DMX_PES_OTHER;
+	pes.flags = DMX_IMMEDIATE_START;
+	if (ioctl(fd, DMX_SET_PES_FILTER, &pes) < 0) {
+		close(fd);
+		return NULL;
+	}
+	ts = dddvb_ts_open_fd(fd);
+	if (!ts) {
+		close(fd);
+		return NULL;
+	}
+	ts->own_fd = 1;
+	return ts;
+}
+
+LIBDDDVB_EXPORTED void dddvb_ts_close(struct dddvb_ts *ts)
+{
+	int i;
+
+	pthread_mutex_lock(&ts->lock);
+	ts->exit = 1;
+	pthread_cond_signal(&ts->space);
+	pthread_mutex_unlock(&ts->lock);
+	pthread_join(ts->pt, NULL);
+	for (i = 0; i < DDDVB_TS_MAX_SUB; i++)
+		if (ts->sub[i])
+			dddvb_ts_unsubscribe(ts->sub[i]);
+	if (ts->own_fd)
+		close(ts->fd);
+	pthread_cond_destroy(&ts->space);
+	free(ts->buf);
+	free(ts);
+}
+
+LIBDDDVB_EXPORTED struct dddvb_ts_sub *dddvb_ts_subscribe(struct dddvb_ts *ts, uint32_t flags)
+{
+	struct dddvb_ts_sub *sub;
+	int i;
+
+	sub = calloc(1, sizeof(struct dddvb_ts_sub));
+	if (!sub)
+		return NULL;
+	sub->ts = ts;
+	sub->flags = flags;
+	sub->qsize = DDDVB_TS_SUB_QUEUE;
+	sub->q = malloc(sub->qsize * sizeof(uint32_t));
+	sub->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (!sub->q || sub->evfd < 0)
+		goto fail;
+	pthread_mutex_lock(&ts->lock);
+	for (i = 0; i < DDDVB_TS_MAX_SUB; i++)
+		if (!ts->sub[i])
+			break;
+	if (i == DDDVB_TS_MAX_SUB) {
+		pthread_mutex_unlock(&ts->lock);
+		goto fail;
+	}
+	sub->id = i;
+	ts->sub[i] = sub;
+	ts->active |= 1ULL << i;
+	pthread_mutex_unlock(&ts->lock);
+	return sub;
+fail:
+	if (sub->evfd >= 0)
+		close(sub->evfd);
+	free(sub->q);
+	free(sub);
+	return NULL;
+}
+
+LIBDDDVB_EXPORTED void dddvb_ts_unsubscribe(struct dddvb_ts_sub *sub)
+{
+	struct dddvb_ts *ts = sub->ts;
+	uint64_t bit = 1ULL << sub->id;
+	int i;
+
+	pthread_mutex_lock(&ts->lock);
+	ts->active &= ~bit;
+	for (i = 0; i < 8192; i++)
+		ts->pidmask[i] &= ~bit;
+	ts->sub[sub->id] = NULL;
+	pthread_cond_signal(&ts->space);
+	pthread_mutex_unlock(&ts->lock);
+	close(sub->evfd);
+	free(sub->q);
+	free(sub);
+}
+
+/* add (on != 0) or remove a PID, 0x2000 selects all PIDs */
+LIBDDDVB_EXPORTED int dddvb_ts_sub_pid(struct dddvb_ts_sub *sub, uint16_t pid, int on)
+{
+	struct dddvb_ts *ts = sub->ts;
+	uint64_t bit = 1ULL << sub->id;
+	int i, first = pid, last = pid;
+
+	if (pid == 0x2000) {
+		first = 0;
+		last = 8191;
+	} else if (pid > 8191)
+		return -EINVAL;
+	pthread_mutex_lock(&ts->lock);
+	for (i = first; i <= last; i++)
+		if (on)
+			ts->pidmask[i] |= bit;
+		else
+			ts->pidmask[i] &= ~bit;
+	pthread_mutex_unlock(&ts->lock);
+	return 0;
+}
+
+/* becomes readable when packets are queued for the subscriber */
+LIBDDDVB_EXPORTED int dddvb_ts_sub_fd(struct dddvb_ts_sub *sub)
+{
+	return sub->evfd;
+}
+
+/*
+ * Return pointers to up to max queued packets without removing them.
+ * They stay valid until dddvb_ts_sub_ack().
+ */
+LIBDDDVB_EXPORTED int dddvb_ts_sub_read(struct dddvb_ts_sub *sub, const uint8_t **pkt, int max)
+{
+	struct dddvb_ts *ts = sub->ts;
+	uint32_t wp, n, i, seq;
+	uint64_t val;
+
+	if (read(sub->evfd, &val, sizeof(val)) < 0 && errno != EAGAIN)
+		return -errno;
+	if (__atomic_load_n(&sub->overflow, __ATOMIC_ACQUIRE)) {
+		pthread_mutex_lock(&ts->lock);
+		__atomic_store_n(&sub->rp, sub->wp, __ATOMIC_RELEASE);
+		sub->overflow = 0;
+		pthread_cond_signal(&ts->space);
+		pthread_mutex_unlock(&ts->lock);
+		return -EOVERFLOW;
+	}
+	wp = __atomic_load_n(&sub->wp, __ATOMIC_ACQUIRE);
+	n = wp - sub->rp;
+	if (n > max)
+		n = max;
+	for (i = 0; i < n; i++) {
+		seq = sub->q[(sub->rp + i) & (sub->qsize - 1)];
+		pkt[i] = ts->buf + (seq % ts->npkt) * 188;
+	}
+	/* the eventfd was drained above, keep it readable for the rest */
+	if (wp - sub->rp > n)
+		ts_signal(sub->evfd);
+	return n;
+}
+
+LIBDDDVB_EXPORTED void dddvb_ts_sub_ack(struct dddvb_ts_sub *sub, int n)
+{
+	struct dddvb_ts *ts = sub->ts;
+
+	__atomic_store_n(&sub->rp, sub->rp + n, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ts->space_wait, __ATOMIC_SEQ_CST)) {
+		pthread_mutex_lock(&ts->lock);
+		pthread_cond_signal(&ts->space);
+		pthread_mutex_unlock(&ts->lock);
+	}
+}